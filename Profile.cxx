@@ -0,0 +1,79 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Profile.h"
+
+#ifdef VTKBOOL_PROFILE
+
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+// prozessweit, damit die allokationen in den threads von vtkSMPTools mitgezählt werden
+// gleichzeitig laufende filter werden daher nicht getrennt
+// unter windows gilt der ersatz nur für die dll selbst, allokationen in vtk werden dort nicht gezählt
+
+static std::atomic<std::size_t> numAllocs(0), numBytes(0);
+
+void* operator new (std::size_t size) {
+    numAllocs.fetch_add(1, std::memory_order_relaxed);
+    numBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void *p = std::malloc(size == 0 ? 1 : size);
+
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete (void *p) noexcept {
+    std::free(p);
+}
+
+AllocCounts GetAllocCounts () {
+    return AllocCounts{numAllocs.load(std::memory_order_relaxed), numBytes.load(std::memory_order_relaxed)};
+}
+
+std::size_t GetCurrentRss () {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.WorkingSetSize;
+    }
+#elif defined(__linux__)
+    // die zweite spalte sind die residenten seiten
+    std::ifstream f("/proc/self/statm");
+    std::size_t size, resident;
+
+    if (f >> size >> resident) {
+        return resident*sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return 0;
+}
+
+#endif
@@ -14,5 +14,27 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
-#include "Tools.h"
-int Point::_tag = 0;
+#ifndef __Profile_h
+#define __Profile_h
+
+#include <cstddef>
+
+// nur mit VTKBOOL_PROFILE, dann ersetzt Profile.cxx operator new und operator delete
+
+#ifdef VTKBOOL_PROFILE
+
+class AllocCounts {
+public:
+    std::size_t allocs, bytes;
+};
+
+// die aufrufe von operator new in allen threads des prozesses, seit dessen start
+// laufen mehrere filter gleichzeitig, zählen sie die allokationen der anderen mit
+AllocCounts GetAllocCounts ();
+
+// in bytes, 0 wenn das system es nicht liefert
+std::size_t GetCurrentRss ();
+
+#endif
+
+#endif
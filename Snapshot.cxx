@@ -0,0 +1,439 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkCellData.h>
+#include <vtkPointData.h>
+#include <vtkFieldData.h>
+
+#include "Snapshot.h"
+
+static const char magic[8] = {'v', 't', 'k', 'b', 'o', 'o', 'l', 'S'};
+static const std::uint32_t byteOrder = 0x01020304;
+
+void ContentHash::Add (const void *data, std::size_t size) {
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+
+    for (std::size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+void ContentHash::Add (vtkDataArray *arr) {
+    if (arr == nullptr) {
+        Add<std::int32_t>(-1);
+        return;
+    }
+
+    Add<std::int32_t>(arr->GetDataType());
+    Add<std::int32_t>(arr->GetNumberOfComponents());
+    Add<std::int64_t>(arr->GetNumberOfTuples());
+
+    Add(arr->GetVoidPointer(0), arr->GetNumberOfValues()*arr->GetDataTypeSize());
+}
+
+void ContentHash::Add (vtkCellArray *cells) {
+    Add<std::int64_t>(cells->GetNumberOfCells());
+
+    vtkIdType n, *pts;
+
+    for (cells->InitTraversal(); cells->GetNextCell(n, pts);) {
+        Add<std::int64_t>(n);
+
+        for (vtkIdType i = 0; i < n; i++) {
+            Add<std::int64_t>(pts[i]);
+        }
+    }
+}
+
+void ContentHash::Add (vtkPolyData *pd) {
+    Add(pd->GetPoints() != nullptr ? pd->GetPoints()->GetData() : nullptr);
+
+    Add(pd->GetVerts());
+    Add(pd->GetLines());
+    Add(pd->GetPolys());
+    Add(pd->GetStrips());
+
+    // die PointData wird nicht weitergegeben, in modPdA und modPdB steht sie trotzdem
+    std::vector<vtkDataSetAttributes*> _attrs {pd->GetCellData(), pd->GetPointData()};
+
+    for (vtkDataSetAttributes *attrs : _attrs) {
+        int num = attrs->GetNumberOfArrays();
+
+        Add<std::int32_t>(num);
+
+        for (int i = 0; i < num; i++) {
+            const char *name = attrs->GetArrayName(i);
+
+            if (name != nullptr) {
+                Add(name, std::strlen(name));
+            }
+
+            Add<std::int32_t>(attrs->IsArrayAnAttribute(i));
+            Add(attrs->GetArray(i));
+        }
+    }
+}
+
+SnapshotWriter::SnapshotWriter (const std::string &file, std::uint64_t hash) : file(file), pos(0) {
+    // mehrere prozesse können dieselbe datei gleichzeitig erzeugen
+    tmp = file + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())
+        + "." + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + ".tmp";
+
+    out.open(tmp, std::ios::binary);
+
+    if (!out) {
+        throw std::runtime_error("cannot create " + tmp);
+    }
+
+    Put(magic, 8);
+    Put<std::uint32_t>(SNAPSHOT_VERSION);
+    Put<std::uint32_t>(byteOrder);
+    Put<std::uint64_t>(hash);
+}
+
+SnapshotWriter::~SnapshotWriter () {
+    if (out.is_open()) {
+        out.close();
+        std::remove(tmp.c_str());
+    }
+}
+
+void SnapshotWriter::Put (const void *data, std::size_t size) {
+    out.write(static_cast<const char*>(data), size);
+    pos += size;
+}
+
+void SnapshotWriter::Pad () {
+    static const char zeros[8] = {};
+
+    if (pos%8 != 0) {
+        Put(zeros, 8-pos%8);
+    }
+}
+
+bool SnapshotWriter::IsWritable (vtkFieldData *fd) {
+    for (int i = 0; i < fd->GetNumberOfArrays(); i++) {
+        if (fd->GetArray(i) == nullptr) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SnapshotWriter::Write (vtkDataArray *arr, int attr) {
+    std::string name = arr->GetName() != nullptr ? arr->GetName() : "";
+
+    Put<std::int32_t>(arr->GetDataType());
+    Put<std::int32_t>(arr->GetNumberOfComponents());
+    Put<std::int64_t>(arr->GetNumberOfTuples());
+    Put<std::int32_t>(attr);
+    Put<std::int32_t>(name.size());
+
+    Put(name.data(), name.size());
+    Pad();
+
+    Put(arr->GetVoidPointer(0), arr->GetNumberOfValues()*arr->GetDataTypeSize());
+    Pad();
+}
+
+void SnapshotWriter::Write (vtkCellArray *cells) {
+    std::vector<std::int64_t> offs {0}, conn;
+
+    vtkIdType n, *pts;
+
+    for (cells->InitTraversal(); cells->GetNextCell(n, pts);) {
+        conn.insert(conn.end(), pts, pts+n);
+        offs.push_back(conn.size());
+    }
+
+    Put<std::int64_t>(offs.size()-1);
+    Put<std::int64_t>(conn.size());
+
+    Put(offs.data(), offs.size()*8);
+    Put(conn.data(), conn.size()*8);
+}
+
+void SnapshotWriter::Write (vtkDataSetAttributes *attrs) {
+    int num = attrs->GetNumberOfArrays();
+
+    Put<std::int64_t>(num);
+
+    for (int i = 0; i < num; i++) {
+        Write(attrs->GetArray(i), attrs->IsArrayAnAttribute(i));
+    }
+}
+
+void SnapshotWriter::Write (vtkPolyData *pd) {
+    if (pd->GetPoints() == nullptr) {
+        throw std::runtime_error("polydata without points");
+    }
+
+    Write(pd->GetPoints()->GetData());
+
+    Write(pd->GetVerts());
+    Write(pd->GetLines());
+    Write(pd->GetPolys());
+    Write(pd->GetStrips());
+
+    // gelöschte zellen stehen weiterhin in den cell-arrays
+    std::vector<std::int64_t> deleted;
+
+    for (vtkIdType i = 0; i < pd->GetNumberOfCells(); i++) {
+        if (pd->GetCellType(i) == VTK_EMPTY_CELL) {
+            deleted.push_back(i);
+        }
+    }
+
+    Put<std::int64_t>(deleted.size());
+    Put(deleted.data(), deleted.size()*8);
+
+    Write(pd->GetCellData());
+    Write(pd->GetPointData());
+}
+
+void SnapshotWriter::Write (const std::set<int> &ids) {
+    std::vector<std::int32_t> _ids(ids.begin(), ids.end());
+
+    Put<std::int64_t>(_ids.size());
+    Put(_ids.data(), _ids.size()*4);
+    Pad();
+}
+
+void SnapshotWriter::Close () {
+    out.close();
+
+    if (out.fail()) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot write " + tmp);
+    }
+
+    // unter windows scheitert rename an einer vorhandenen datei
+    std::remove(file.c_str());
+
+    if (std::rename(tmp.c_str(), file.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot rename " + tmp);
+    }
+}
+
+SnapshotReader::SnapshotReader (const std::string &file) : in(file, std::ios::binary | std::ios::ate), pos(0), fileSize(0) {
+    if (in.is_open()) {
+        fileSize = in.tellg();
+        in.seekg(0);
+
+        // eine zu kurze datei führt zu einer ausnahme
+        in.exceptions(std::ios::failbit | std::ios::badbit);
+    }
+}
+
+bool SnapshotReader::Open (std::uint64_t hash) {
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char _magic[8];
+
+    try {
+        Get(_magic, 8);
+
+        if (std::memcmp(_magic, magic, 8) != 0
+            || Get<std::uint32_t>() != SNAPSHOT_VERSION
+            || Get<std::uint32_t>() != byteOrder
+            || Get<std::uint64_t>() != hash) {
+
+            return false;
+        }
+    } catch (const std::ios::failure&) {
+        return false;
+    }
+
+    return true;
+}
+
+void SnapshotReader::Get (void *data, std::size_t size) {
+    in.read(static_cast<char*>(data), size);
+    pos += size;
+}
+
+std::int64_t SnapshotReader::GetCount () {
+    std::int64_t n = Get<std::int64_t>();
+
+    // eine beschädigte datei soll nicht zu riesigen allokationen führen
+    if (n < 0 || n > fileSize) {
+        throw std::runtime_error("invalid count");
+    }
+
+    return n;
+}
+
+void SnapshotReader::Pad () {
+    if (pos%8 != 0) {
+        in.seekg(8-pos%8, std::ios::cur);
+        pos += 8-pos%8;
+    }
+}
+
+vtkSmartPointer<vtkDataArray> SnapshotReader::ReadArray (int &attr) {
+    int type = Get<std::int32_t>(),
+        comps = Get<std::int32_t>();
+
+    std::int64_t tuples = Get<std::int64_t>();
+
+    attr = Get<std::int32_t>();
+
+    std::int32_t len = Get<std::int32_t>();
+
+    if (comps < 1 || tuples < 0 || tuples*comps > fileSize || len < 0 || len > fileSize) {
+        throw std::runtime_error("invalid array");
+    }
+
+    std::string name(len, '\0');
+    Get(&name[0], len);
+    Pad();
+
+    vtkSmartPointer<vtkDataArray> arr;
+    arr.TakeReference(vtkDataArray::CreateDataArray(type));
+
+    if (arr == nullptr) {
+        throw std::runtime_error("invalid array type");
+    }
+
+    if (!name.empty()) {
+        arr->SetName(name.c_str());
+    }
+
+    arr->SetNumberOfComponents(comps);
+    arr->SetNumberOfTuples(tuples);
+
+    Get(arr->GetVoidPointer(0), arr->GetNumberOfValues()*arr->GetDataTypeSize());
+    Pad();
+
+    return arr;
+}
+
+vtkSmartPointer<vtkCellArray> SnapshotReader::ReadCells () {
+    std::int64_t numCells = GetCount(),
+        numIds = GetCount();
+
+    std::vector<std::int64_t> offs(numCells+1), conn(numIds);
+
+    Get(offs.data(), offs.size()*8);
+    Get(conn.data(), conn.size()*8);
+
+    if (offs.front() != 0 || offs.back() != numIds || !std::is_sorted(offs.begin(), offs.end())) {
+        throw std::runtime_error("invalid offsets");
+    }
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->Allocate(numCells+numIds);
+
+    std::vector<vtkIdType> ids(conn.begin(), conn.end());
+
+    for (std::int64_t i = 0; i < numCells; i++) {
+        cells->InsertNextCell(offs[i+1]-offs[i], ids.data()+offs[i]);
+    }
+
+    return cells;
+}
+
+void SnapshotReader::Read (vtkDataSetAttributes *attrs) {
+    attrs->Initialize();
+
+    std::int64_t num = GetCount();
+
+    for (std::int64_t i = 0; i < num; i++) {
+        int attr;
+
+        vtkSmartPointer<vtkDataArray> arr = ReadArray(attr);
+
+        attrs->AddArray(arr);
+
+        if (attr >= 0) {
+            attrs->SetActiveAttribute(arr->GetName(), attr);
+        }
+    }
+}
+
+void SnapshotReader::Read (vtkPolyData *pd) {
+    pd->Initialize();
+
+    int attr;
+
+    vtkSmartPointer<vtkPoints> pts = vtkSmartPointer<vtkPoints>::New();
+    pts->SetData(ReadArray(attr));
+
+    pd->SetPoints(pts);
+
+    vtkSmartPointer<vtkCellArray> cells[4];
+
+    for (auto &c : cells) {
+        c = ReadCells();
+
+        vtkIdType n, *ids;
+
+        for (c->InitTraversal(); c->GetNextCell(n, ids);) {
+            for (vtkIdType i = 0; i < n; i++) {
+                if (ids[i] < 0 || ids[i] >= pts->GetNumberOfPoints()) {
+                    throw std::runtime_error("index out of range");
+                }
+            }
+        }
+    }
+
+    pd->SetVerts(cells[0]);
+    pd->SetLines(cells[1]);
+    pd->SetPolys(cells[2]);
+    pd->SetStrips(cells[3]);
+
+    std::vector<std::int64_t> deleted(GetCount());
+    Get(deleted.data(), deleted.size()*8);
+
+    if (!deleted.empty()) {
+        pd->BuildCells();
+
+        for (std::int64_t id : deleted) {
+            if (id < 0 || id >= pd->GetNumberOfCells()) {
+                throw std::runtime_error("invalid cell id");
+            }
+
+            pd->DeleteCell(id);
+        }
+    }
+
+    Read(pd->GetCellData());
+    Read(pd->GetPointData());
+}
+
+void SnapshotReader::Read (std::set<int> &ids) {
+    std::vector<std::int32_t> _ids(GetCount());
+
+    Get(_ids.data(), _ids.size()*4);
+    Pad();
+
+    ids.clear();
+    ids.insert(_ids.begin(), _ids.end());
+}
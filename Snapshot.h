@@ -0,0 +1,120 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __Snapshot_h
+#define __Snapshot_h
+
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <set>
+
+#include <vtkPolyData.h>
+#include <vtkDataArray.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkSmartPointer.h>
+
+// binäres abbild des zustands vor der zerlegung
+//
+// aufbau: kopf (magic, version, byte-order, hash), danach die abschnitte in fester reihenfolge
+// alle zahlen in der byte-order des erzeugers, jedes feld und jedes array beginnt an einer durch 8 teilbaren position
+// ein array ist {typ, komponenten, tupel, attribut, länge des namens}, der name und die rohdaten, jeweils aufgefüllt
+
+// muss bei jeder änderung an den schritten vor DecPolys_ erhöht werden
+#define SNAPSHOT_VERSION 2
+
+// FNV-1a über den inhalt, nicht über die MTime
+class ContentHash {
+    std::uint64_t h;
+public:
+    ContentHash () : h(14695981039346656037ULL) {}
+
+    void Add (const void *data, std::size_t size);
+
+    template<typename T>
+    void Add (const T &v) {
+        Add(&v, sizeof(T));
+    }
+
+    void Add (vtkDataArray *arr);
+    void Add (vtkCellArray *cells);
+    void Add (vtkPolyData *pd);
+
+    std::uint64_t Get () const { return h; }
+};
+
+class SnapshotWriter {
+    std::string file, tmp;
+    std::ofstream out;
+    std::uint64_t pos;
+
+    void Put (const void *data, std::size_t size);
+    void Pad ();
+
+    template<typename T>
+    void Put (T v) {
+        Put(&v, sizeof(T));
+    }
+
+public:
+    // schreibt zuerst in eine temporäre datei, Close benennt sie um
+    SnapshotWriter (const std::string &file, std::uint64_t hash);
+    ~SnapshotWriter ();
+
+    // false bei arrays, die keine vtkDataArray sind
+    static bool IsWritable (vtkFieldData *fd);
+
+    void Write (vtkDataArray *arr, int attr = -1);
+    void Write (vtkCellArray *cells);
+    void Write (vtkDataSetAttributes *attrs);
+    void Write (vtkPolyData *pd);
+    void Write (const std::set<int> &ids);
+
+    void Close ();
+};
+
+class SnapshotReader {
+    std::ifstream in;
+    std::uint64_t pos;
+    std::int64_t fileSize;
+
+    void Get (void *data, std::size_t size);
+    void Pad ();
+
+    // eine anzahl, höchstens so groß wie die datei
+    std::int64_t GetCount ();
+
+    template<typename T>
+    T Get () {
+        T v;
+        Get(&v, sizeof(T));
+        return v;
+    }
+
+public:
+    SnapshotReader (const std::string &file);
+
+    // false, wenn die datei fehlt oder zu anderen eingaben oder einer anderen version gehört
+    bool Open (std::uint64_t hash);
+
+    vtkSmartPointer<vtkDataArray> ReadArray (int &attr);
+    vtkSmartPointer<vtkCellArray> ReadCells ();
+    void Read (vtkDataSetAttributes *attrs);
+    void Read (vtkPolyData *pd);
+    void Read (std::set<int> &ids);
+};
+
+#endif
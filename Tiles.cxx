@@ -0,0 +1,567 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <vtkCellData.h>
+#include <vtkIntArray.h>
+#include <vtkIdList.h>
+#include <vtkTriangleStrip.h>
+#include <vtkKdTreePointLocator.h>
+
+#include "Tiles.h"
+#include "vtkPolyDataBooleanFilter.h"
+
+TileGrid::TileGrid (const double *_bnds, double tileSize) {
+    for (int i = 0; i < 3; i++) {
+        bnds[2*i] = _bnds[2*i];
+        bnds[2*i+1] = _bnds[2*i+1];
+
+        double len = bnds[2*i+1]-bnds[2*i];
+
+        dims[i] = std::max(1, std::min(TILES_MAX_DIM, static_cast<int>(std::ceil(len/tileSize))));
+        size[i] = len/dims[i];
+    }
+}
+
+void TileGrid::GetBounds (vtkIdType tile, double *tileBnds, double halo) const {
+    vtkIdType ind[] = {tile%dims[0], (tile/dims[0])%dims[1], tile/(dims[0]*dims[1])};
+
+    for (int i = 0; i < 3; i++) {
+        tileBnds[2*i] = bnds[2*i]+ind[i]*size[i]-halo;
+        tileBnds[2*i+1] = bnds[2*i]+(ind[i]+1)*size[i]+halo;
+    }
+}
+
+vtkIdType TileGrid::GetOwner (const double *cellBnds) const {
+    vtkIdType ind[3];
+
+    for (int i = 0; i < 3; i++) {
+        ind[i] = 0;
+
+        if (size[i] > 0) {
+            double c = (cellBnds[2*i]+cellBnds[2*i+1])/2;
+            ind[i] = std::max(0, std::min(dims[i]-1, static_cast<int>(std::floor((c-bnds[2*i])/size[i]))));
+        }
+    }
+
+    return ind[0]+dims[0]*(ind[1]+dims[1]*ind[2]);
+}
+
+void TileGrid::GetTiles (const double *cellBnds, double halo, std::vector<vtkIdType> &tiles) const {
+    tiles.clear();
+
+    int lo[3], hi[3];
+
+    for (int i = 0; i < 3; i++) {
+        double a = cellBnds[2*i]-halo-bnds[2*i],
+            b = cellBnds[2*i+1]+halo-bnds[2*i];
+
+        if (size[i] > 0) {
+            // die k-te kachel reicht von k*size bis (k+1)*size
+            double l = std::ceil(a/size[i]-1),
+                h = std::floor(b/size[i]);
+
+            lo[i] = l < 0 ? 0 : static_cast<int>(std::min(l, static_cast<double>(dims[i])));
+            hi[i] = h >= dims[i] ? dims[i]-1 : static_cast<int>(std::max(h, -1.));
+        } else {
+            lo[i] = 0;
+            hi[i] = a <= 0 && b >= 0 ? 0 : -1;
+        }
+
+        if (lo[i] > hi[i]) {
+            return;
+        }
+    }
+
+    for (int k = lo[2]; k <= hi[2]; k++) {
+        for (int j = lo[1]; j <= hi[1]; j++) {
+            for (int i = lo[0]; i <= hi[0]; i++) {
+                tiles.push_back(i+static_cast<vtkIdType>(dims[0])*(j+static_cast<vtkIdType>(dims[1])*k));
+            }
+        }
+    }
+}
+
+DisjointSets::DisjointSets (vtkIdType n) : parents(n) {
+    for (vtkIdType i = 0; i < n; i++) {
+        parents[i] = i;
+    }
+}
+
+vtkIdType DisjointSets::Add () {
+    parents.push_back(parents.size());
+    return parents.size()-1;
+}
+
+vtkIdType DisjointSets::Find (vtkIdType i) {
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+
+    return i;
+}
+
+void DisjointSets::Union (vtkIdType a, vtkIdType b) {
+    a = Find(a);
+    b = Find(b);
+
+    if (a < b) {
+        parents[b] = a;
+    } else if (b < a) {
+        parents[a] = b;
+    }
+}
+
+void ConnectCells (vtkPolyData *pd, DisjointSets &sets) {
+    vtkIdType i, j, num, *poly, numCells = pd->GetNumberOfCells();
+
+    for (i = 0; i < numCells; i++) {
+        if (pd->GetCellType(i) == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        pd->GetCellPoints(i, num, poly);
+
+        for (j = 1; j < num; j++) {
+            sets.Union(poly[0], poly[j]);
+        }
+    }
+}
+
+TilePart::TilePart (vtkPolyData *in, const std::vector<vtkIdType> &cells, const TileGrid &grid, vtkIdType tile, double halo, const double *overlap) {
+    double tileBnds[6], cellBnds[6];
+    grid.GetBounds(tile, tileBnds, halo);
+
+    vtkPoints *pts = vtkPoints::New();
+    pts->SetDataTypeToDouble();
+
+    vtkCellArray *polys = vtkCellArray::New();
+    vtkCellArray *tris = vtkCellArray::New();
+
+    std::unordered_map<vtkIdType, vtkIdType> ids;
+
+    std::vector<vtkIdType> poly;
+
+    vtkIdType num, *cell;
+
+    auto Insert = [&] (vtkIdType num, const vtkIdType *cell) {
+        poly.clear();
+
+        for (vtkIdType i = 0; i < num; i++) {
+            auto itr = ids.find(cell[i]);
+
+            if (itr == ids.end()) {
+                itr = ids.emplace(cell[i], pts->InsertNextPoint(in->GetPoint(cell[i]))).first;
+                ptIds.push_back(cell[i]);
+            }
+
+            poly.push_back(itr->second);
+        }
+
+        polys->InsertNextCell(num, poly.data());
+    };
+
+    for (vtkIdType id : cells) {
+        in->GetCellBounds(id, cellBnds);
+
+        bool inside = cellBnds[0] >= tileBnds[0] && cellBnds[1] <= tileBnds[1]
+            && cellBnds[2] >= tileBnds[2] && cellBnds[3] <= tileBnds[3]
+            && cellBnds[4] >= tileBnds[4] && cellBnds[5] <= tileBnds[5];
+
+        // zuständig ist die kachel nur für zellen im überlappungsbereich, die übrigen bleiben unverändert
+        bool own = grid.GetOwner(cellBnds) == tile
+            && cellBnds[0] <= overlap[1] && cellBnds[1] >= overlap[0]
+            && cellBnds[2] <= overlap[3] && cellBnds[3] >= overlap[2]
+            && cellBnds[4] <= overlap[5] && cellBnds[5] >= overlap[4];
+
+        in->GetCellPoints(id, num, cell);
+
+        if (in->GetCellType(id) == VTK_TRIANGLE_STRIP) {
+            tris->Reset();
+
+            vtkTriangleStrip::DecomposeStrip(num, cell, tris);
+
+            for (tris->InitTraversal(); tris->GetNextCell(num, cell);) {
+                if (cell[0] != cell[1] && cell[1] != cell[2] && cell[2] != cell[0]) {
+                    Insert(num, cell);
+
+                    cellIds.push_back(id);
+                    complete.push_back(inside);
+                    owned.push_back(own);
+                }
+            }
+
+        } else {
+            Insert(num, cell);
+
+            cellIds.push_back(id);
+            complete.push_back(inside);
+            owned.push_back(own);
+        }
+    }
+
+    pd = vtkSmartPointer<vtkPolyData>::New();
+    pd->SetPoints(pts);
+    pd->SetPolys(polys);
+
+    tris->Delete();
+    polys->Delete();
+    pts->Delete();
+}
+
+void TilePart::GetIncompletePoints (vtkPolyData *cut, std::vector<bool> &pts) const {
+    vtkIntArray *origCellIds = vtkIntArray::SafeDownCast(cut->GetCellData()->GetScalars("OrigCellIds"));
+
+    pts.assign(cut->GetNumberOfPoints(), false);
+
+    vtkIdType i, j, num, *poly, numCells = cut->GetNumberOfCells();
+
+    for (i = 0; i < numCells; i++) {
+        if (cut->GetCellType(i) == VTK_EMPTY_CELL || complete[origCellIds->GetValue(i)]) {
+            continue;
+        }
+
+        cut->GetCellPoints(i, num, poly);
+
+        for (j = 0; j < num; j++) {
+            pts[poly[j]] = true;
+        }
+    }
+}
+
+TiledMesh::TiledMesh (vtkPolyData *in) : in(in), maxExt(0), sets(in->GetNumberOfPoints()), touched(in->GetNumberOfCells(), false) {
+    pieces = vtkSmartPointer<vtkCellArray>::New();
+
+    newPts = vtkSmartPointer<vtkPoints>::New();
+    newPts->SetDataTypeToDouble();
+
+    double cellBnds[6];
+
+    vtkIdType i, numCells = in->GetNumberOfCells();
+
+    for (i = 0; i < numCells; i++) {
+        int type = in->GetCellType(i);
+
+        if (type == VTK_VERTEX || type == VTK_POLY_VERTEX || type == VTK_LINE || type == VTK_POLY_LINE || type == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        in->GetCellBounds(i, cellBnds);
+
+        maxExt = std::max({maxExt, cellBnds[1]-cellBnds[0], cellBnds[3]-cellBnds[2], cellBnds[5]-cellBnds[4]});
+    }
+}
+
+void TiledMesh::Distribute (const TileGrid &grid, double halo, std::vector<std::vector<vtkIdType>> &tileCells) const {
+    double cellBnds[6];
+
+    std::vector<vtkIdType> tiles;
+
+    vtkIdType i, numCells = in->GetNumberOfCells();
+
+    for (i = 0; i < numCells; i++) {
+        int type = in->GetCellType(i);
+
+        if (type == VTK_VERTEX || type == VTK_POLY_VERTEX || type == VTK_LINE || type == VTK_POLY_LINE || type == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        in->GetCellBounds(i, cellBnds);
+
+        grid.GetTiles(cellBnds, halo, tiles);
+
+        for (vtkIdType tile : tiles) {
+            tileCells[tile].push_back(i);
+        }
+    }
+}
+
+void TiledMesh::AddTile (const TilePart &part, vtkPolyData *cut, DisjointSets &regions, const std::map<int, int> &_locs) {
+    vtkIntArray *origCellIds = vtkIntArray::SafeDownCast(cut->GetCellData()->GetScalars("OrigCellIds"));
+
+    vtkIdType numOrigPts = part.ptIds.size(),
+        numParts = part.cellIds.size(),
+        numPts = in->GetNumberOfPoints();
+
+    // jede region der kachel wird ein knoten
+    std::unordered_map<vtkIdType, vtkIdType> nodes;
+
+    auto Node = [&] (vtkIdType root) {
+        auto itr = nodes.find(root);
+
+        if (itr == nodes.end()) {
+            itr = nodes.emplace(root, sets.Add()).first;
+        }
+
+        return itr->second;
+    };
+
+    // je zelle von part.pd ihre teile
+    std::vector<std::vector<vtkIdType>> descs(numParts);
+
+    vtkIdType i, j, num, *poly, numCells = cut->GetNumberOfCells();
+
+    for (i = 0; i < numCells; i++) {
+        cut->GetCellPoints(i, num, poly);
+
+        vtkIdType node = Node(regions.Find(poly[0]));
+
+        // über die ursprünglichen punkte hängen die regionen der kacheln und die unveränderten zellen zusammen
+        // die punkte auf den kontaktlinien sind nach DisjoinPolys nicht mehr darunter
+
+        for (j = 0; j < num; j++) {
+            if (poly[j] < numOrigPts) {
+                sets.Union(node, part.ptIds[poly[j]]);
+            }
+        }
+
+        descs[origCellIds->GetValue(i)].push_back(i);
+    }
+
+    for (auto &l : _locs) {
+        locs[Node(l.first)] = l.second;
+    }
+
+    vtkIdType _num, *_poly;
+
+    for (i = 0; i < numParts; i++) {
+        if (!part.owned[i]) {
+            continue;
+        }
+
+        bool same = descs[i].size() == 1;
+
+        if (same) {
+            part.pd->GetCellPoints(i, _num, _poly);
+            cut->GetCellPoints(descs[i].front(), num, poly);
+
+            same = num == _num && std::equal(poly, poly+num, _poly);
+        }
+
+        if (!same) {
+            touched[part.cellIds[i]] = true;
+        }
+    }
+
+    // die teile aller veränderten zellen übernehmen
+
+    std::unordered_map<vtkIdType, vtkIdType> newIds;
+
+    std::vector<vtkIdType> ids;
+
+    double pt[3];
+
+    for (i = 0; i < numParts; i++) {
+        if (!part.owned[i] || !touched[part.cellIds[i]]) {
+            continue;
+        }
+
+        for (vtkIdType d : descs[i]) {
+            cut->GetCellPoints(d, num, poly);
+
+            vtkIdType node = Node(regions.Find(poly[0]));
+
+            ids.clear();
+
+            for (j = 0; j < num; j++) {
+                if (poly[j] < numOrigPts) {
+                    ids.push_back(part.ptIds[poly[j]]);
+                } else {
+                    auto itr = newIds.find(poly[j]);
+
+                    if (itr == newIds.end()) {
+                        cut->GetPoint(poly[j], pt);
+
+                        itr = newIds.emplace(poly[j], numPts+newPts->InsertNextPoint(pt)).first;
+                        newPtNodes.push_back(node);
+                    }
+
+                    ids.push_back(itr->second);
+                }
+            }
+
+            pieces->InsertNextCell(num, ids.data());
+
+            pieceIds.push_back(part.cellIds[i]);
+            pieceNodes.push_back(node);
+        }
+    }
+}
+
+vtkSmartPointer<vtkPolyData> TiledMesh::GetRegions (const std::function<int (int)> &select) {
+    vtkIdType i, j, num, *poly, numCells = in->GetNumberOfCells(), numPts = in->GetNumberOfPoints();
+
+    // die unveränderten zellen verbinden ihre punkte
+
+    for (i = 0; i < numCells; i++) {
+        int type = in->GetCellType(i);
+
+        if (touched[i] || type == VTK_VERTEX || type == VTK_POLY_VERTEX || type == VTK_LINE || type == VTK_POLY_LINE || type == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        in->GetCellPoints(i, num, poly);
+
+        for (j = 1; j < num; j++) {
+            sets.Union(poly[0], poly[j]);
+        }
+    }
+
+    // wie in CombineRegions gewinnt die zuletzt ermittelte lage
+
+    std::unordered_map<vtkIdType, int> rootLocs;
+
+    for (auto &l : locs) {
+        rootLocs[sets.Find(l.first)] = l.second;
+    }
+
+    auto Select = [&] (vtkIdType node) {
+        auto itr = rootLocs.find(sets.Find(node));
+        return select(itr == rootLocs.end() ? LOC_NONE : itr->second);
+    };
+
+    // die neuen punkte gleicher regionen an den grenzen der kacheln vereinen
+
+    vtkIdType numNewPts = newPts->GetNumberOfPoints();
+
+    std::vector<vtkIdType> reps(numNewPts);
+
+    if (numNewPts > 0) {
+        vtkPolyData *pd = vtkPolyData::New();
+        pd->SetPoints(newPts);
+
+        vtkKdTreePointLocator *loc = vtkKdTreePointLocator::New();
+        loc->SetDataSet(pd);
+        loc->BuildLocator();
+
+        vtkIdList *found = vtkIdList::New();
+
+        double pt[3];
+
+        for (i = 0; i < numNewPts; i++) {
+            reps[i] = i;
+
+            newPts->GetPoint(i, pt);
+            loc->FindPointsWithinRadius(1e-6, pt, found);
+
+            vtkIdType root = sets.Find(newPtNodes[i]);
+
+            for (j = 0; j < found->GetNumberOfIds(); j++) {
+                vtkIdType k = found->GetId(j);
+
+                if (k < i && reps[k] < reps[i] && sets.Find(newPtNodes[k]) == root) {
+                    reps[i] = reps[k];
+                }
+            }
+        }
+
+        found->Delete();
+        loc->Delete();
+        pd->Delete();
+    }
+
+    vtkPoints *pts = vtkPoints::New();
+    pts->DeepCopy(in->GetPoints());
+
+    std::vector<vtkIdType> outIds(numNewPts);
+
+    for (i = 0; i < numNewPts; i++) {
+        outIds[i] = reps[i] == i ? pts->InsertNextPoint(newPts->GetPoint(i)) : outIds[reps[i]];
+    }
+
+    vtkCellArray *polys = vtkCellArray::New();
+
+    vtkIntArray *origCellIds = vtkIntArray::New();
+    origCellIds->SetName("OrigCellIds");
+
+    std::vector<vtkIdType> ids;
+
+    auto Add = [&] (vtkIdType num, const vtkIdType *poly, int sel, vtkIdType cellId) {
+        ids.assign(poly, poly+num);
+
+        for (vtkIdType &id : ids) {
+            if (id >= numPts) {
+                id = outIds[id-numPts];
+            }
+        }
+
+        if (sel == 2) {
+            std::reverse(ids.begin(), ids.end());
+        }
+
+        polys->InsertNextCell(num, ids.data());
+        origCellIds->InsertNextValue(cellId);
+    };
+
+    vtkCellArray *tris = vtkCellArray::New();
+
+    for (i = 0; i < numCells; i++) {
+        int type = in->GetCellType(i);
+
+        if (touched[i] || type == VTK_VERTEX || type == VTK_POLY_VERTEX || type == VTK_LINE || type == VTK_POLY_LINE || type == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        in->GetCellPoints(i, num, poly);
+
+        int sel = Select(poly[0]);
+
+        if (sel == 0) {
+            continue;
+        }
+
+        if (type == VTK_TRIANGLE_STRIP) {
+            // wie in vtkPolyDataContactFilter::PreparePolyData
+
+            tris->Reset();
+
+            vtkTriangleStrip::DecomposeStrip(num, poly, tris);
+
+            for (tris->InitTraversal(); tris->GetNextCell(num, poly);) {
+                if (poly[0] != poly[1] && poly[1] != poly[2] && poly[2] != poly[0]) {
+                    Add(num, poly, sel, i);
+                }
+            }
+
+        } else {
+            Add(num, poly, sel, i);
+        }
+    }
+
+    tris->Delete();
+
+    for (i = 0, pieces->InitTraversal(); pieces->GetNextCell(num, poly); i++) {
+        int sel = Select(pieceNodes[i]);
+
+        if (sel != 0) {
+            Add(num, poly, sel, pieceIds[i]);
+        }
+    }
+
+    vtkSmartPointer<vtkPolyData> regs = vtkSmartPointer<vtkPolyData>::New();
+    regs->SetPoints(pts);
+    regs->SetPolys(polys);
+    regs->GetCellData()->SetScalars(origCellIds);
+
+    origCellIds->Delete();
+    polys->Delete();
+    pts->Delete();
+
+    return regs;
+}
@@ -0,0 +1,128 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __Tiles_h
+#define __Tiles_h
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkSmartPointer.h>
+
+// gekachelter modus: der überlappungsbereich der eingaben wird in ein gitter aus kacheln zerlegt
+// jede kachel schneidet nur die zellen, die sie mit halo berührt, die ergebnisse werden danach zusammengesetzt
+
+// höchstens so viele kacheln je achse
+#define TILES_MAX_DIM 64
+
+class TileGrid {
+    double bnds[6], size[3];
+    int dims[3];
+
+public:
+    TileGrid (const double *bnds, double tileSize);
+
+    vtkIdType GetNumberOfTiles () const { return static_cast<vtkIdType>(dims[0])*dims[1]*dims[2]; }
+
+    // um halo vergrößert
+    void GetBounds (vtkIdType tile, double *tileBnds, double halo = 0) const;
+
+    // die kachel mit dem mittelpunkt von cellBnds, außerhalb des gitters die nächste
+    vtkIdType GetOwner (const double *cellBnds) const;
+
+    // alle kacheln, die um halo vergrößert cellBnds berühren
+    void GetTiles (const double *cellBnds, double halo, std::vector<vtkIdType> &tiles) const;
+};
+
+// union-find, die wurzel ist immer das kleinste element
+class DisjointSets {
+    std::vector<vtkIdType> parents;
+
+public:
+    DisjointSets (vtkIdType n = 0);
+
+    vtkIdType Add ();
+    vtkIdType Find (vtkIdType i);
+    void Union (vtkIdType a, vtkIdType b);
+};
+
+// vereint die punkte jeder zelle
+void ConnectCells (vtkPolyData *pd, DisjointSets &sets);
+
+// die zellen einer eingabe, die eine kachel mit halo berühren, mit eigenen punkten
+// streifen werden in dreiecke zerlegt, die ids der zellen von pd sind die indizes der vektoren
+class TilePart {
+public:
+    vtkSmartPointer<vtkPolyData> pd;
+
+    // die zelle der eingabe
+    std::vector<vtkIdType> cellIds;
+
+    // complete: liegt ganz innerhalb der kachel mit halo, alle ihre schnittpartner sind in der kachel
+    // owned: die kachel ist für das ergebnis der zelle zuständig
+    std::vector<bool> complete, owned;
+
+    // je punkt von pd der punkt der eingabe
+    std::vector<vtkIdType> ptIds;
+
+    TilePart (vtkPolyData *in, const std::vector<vtkIdType> &cells, const TileGrid &grid, vtkIdType tile, double halo, const double *overlap);
+
+    // die punkte aller zellen von cut, die von einer unvollständigen zelle abstammen
+    void GetIncompletePoints (vtkPolyData *cut, std::vector<bool> &pts) const;
+};
+
+// sammelt die ergebnisse aller kacheln für eine eingabe
+class TiledMesh {
+    vtkPolyData *in;
+    double maxExt;
+
+    // zuerst die punkte von in, danach die regionen der kacheln
+    DisjointSets sets;
+    std::map<vtkIdType, int> locs;
+
+    // je zelle von in, ob sie in der zuständigen kachel verändert wurde
+    std::vector<bool> touched;
+
+    // die teile der veränderten zellen, ids ab in->GetNumberOfPoints() verweisen auf newPts
+    vtkSmartPointer<vtkCellArray> pieces;
+    std::vector<vtkIdType> pieceIds, pieceNodes;
+
+    vtkSmartPointer<vtkPoints> newPts;
+    std::vector<vtkIdType> newPtNodes;
+
+public:
+    TiledMesh (vtkPolyData *in);
+
+    // die größte ausdehnung einer zelle
+    double GetMaxExtent () const { return maxExt; }
+
+    void Distribute (const TileGrid &grid, double halo, std::vector<std::vector<vtkIdType>> &tileCells) const;
+
+    // cut enthält die geschnittenen vollständigen zellen von part, mit den OrigCellIds von part.pd
+    // regions verbindet die punkte von cut, locs ist die lage der regionen, mit deren wurzel als schlüssel
+    void AddTile (const TilePart &part, vtkPolyData *cut, DisjointSets &regions, const std::map<int, int> &locs);
+
+    // select erhält die lage einer region (LOC_NONE wenn unbekannt), 0 verwirft sie, 1 übernimmt sie, 2 übernimmt sie umgekehrt
+    // die OrigCellIds des ergebnisses sind die ids der zellen von in
+    vtkSmartPointer<vtkPolyData> GetRegions (const std::function<int (int)> &select);
+};
+
+#endif
@@ -17,6 +17,7 @@ limitations under the License.
 #include "Utilities.h"
 
 #include <cmath>
+#include <algorithm>
 
 #include <vtkPoints.h>
 #include <vtkIdList.h>
@@ -88,6 +89,100 @@ void FindPoints (vtkKdTreePointLocator *pl, const double *pt, vtkIdList *pts, do
     closest->Delete();
 }
 
+SubLocator::SubLocator (vtkPolyData *pd, const double *bnds) : pd(pd), sub(nullptr), loc(nullptr) {
+    vtkIdType i, numPts = pd->GetNumberOfPoints();
+
+    double pt[3];
+
+    for (i = 0; i < numPts; i++) {
+        pd->GetPoint(i, pt);
+
+        if (InsideBounds(bnds, pt)) {
+            ids.push_back(i);
+        }
+    }
+
+    Build();
+}
+
+SubLocator::SubLocator (vtkPolyData *pd, const double *bnds, const std::vector<vtkIdType> &cands) : pd(pd), sub(nullptr), loc(nullptr) {
+    double pt[3];
+
+    for (vtkIdType id : cands) {
+        pd->GetPoint(id, pt);
+
+        if (InsideBounds(bnds, pt)) {
+            ids.push_back(id);
+        }
+    }
+
+    Build();
+}
+
+void SubLocator::Build () {
+    vtkPoints *pts = vtkPoints::New();
+    pts->SetDataTypeToDouble();
+    pts->SetNumberOfPoints(ids.size());
+
+    double pt[3];
+
+    for (std::size_t i = 0; i < ids.size(); i++) {
+        pd->GetPoint(ids[i], pt);
+        pts->SetPoint(i, pt);
+    }
+
+    sub = vtkPolyData::New();
+    sub->SetPoints(pts);
+
+    pts->Delete();
+
+    if (!ids.empty()) {
+        loc = vtkKdTreePointLocator::New();
+        loc->SetDataSet(sub);
+        loc->BuildLocator();
+    }
+}
+
+SubLocator::~SubLocator () {
+    if (loc != nullptr) {
+        loc->FreeSearchStructure();
+        loc->Delete();
+    }
+
+    sub->Delete();
+}
+
+void SubLocator::FindPoints (const double *pt, vtkIdList *pts, double tol) {
+    pts->Reset();
+
+    if (loc == nullptr) {
+        return;
+    }
+
+    vtkIdList *closest = vtkIdList::New();
+
+    loc->FindPointsWithinRadius(std::max(1e-3, tol), pt, closest);
+
+    int numPts = closest->GetNumberOfIds();
+
+    double c[3], v[3];
+
+    vtkIdType id;
+
+    for (int i = 0; i < numPts; i++) {
+        id = ids[closest->GetId(i)];
+
+        pd->GetPoint(id, c);
+        vtkMath::Subtract(pt, c, v);
+
+        if (vtkMath::Norm(v) < tol) {
+            pts->InsertNextId(id);
+        }
+    }
+
+    closest->Delete();
+}
+
 void WriteVTK (const char *name, vtkPolyData *pd) {
     vtkDataWriter *w = vtkDataWriter::New();
 
@@ -121,6 +216,28 @@ void WriteVTK (const char *name, vtkPolyData *pd) {
     w->Delete();
 }
 
+void SnapPoints (vtkPolyData *pd, double res) {
+    // rundet alle koordinaten auf ein vielfaches von res
+
+    vtkPoints *pts = pd->GetPoints();
+
+    vtkIdType i, numPts = pts->GetNumberOfPoints();
+
+    double pt[3];
+
+    for (i = 0; i < numPts; i++) {
+        pts->GetPoint(i, pt);
+
+        pt[0] = std::round(pt[0]/res)*res;
+        pt[1] = std::round(pt[1]/res)*res;
+        pt[2] = std::round(pt[2]/res)*res;
+
+        pts->SetPoint(i, pt);
+    }
+
+    pts->Modified();
+}
+
 double GetAngle (double *vA, double *vB, double *n) {
     // http://math.stackexchange.com/questions/878785/how-to-find-an-angle-in-range0-360-between-2-vectors
 
@@ -18,6 +18,7 @@ limitations under the License.
 #define __Utilities_h
 
 #include <iostream>
+#include <vector>
 
 #include <vtkPolyData.h>
 #include <vtkKdTreePointLocator.h>
@@ -34,6 +35,37 @@ double GetD (double *a, double *b);
 void ComputeNormal (vtkPoints *pts, double *n, vtkIdList *poly = nullptr);
 void FindPoints (vtkKdTreePointLocator *pl, const double *pt, vtkIdList *pts, double tol = 1e-6);
 void WriteVTK (const char *name, vtkPolyData *pd);
+void SnapPoints (vtkPolyData *pd, double res);
+
+inline bool InsideBounds (const double *bnds, const double *pt) {
+    return pt[0] >= bnds[0] && pt[0] <= bnds[1]
+        && pt[1] >= bnds[2] && pt[1] <= bnds[3]
+        && pt[2] >= bnds[4] && pt[2] <= bnds[5];
+}
+
+class SubLocator {
+    vtkPolyData *pd, *sub;
+    vtkKdTreePointLocator *loc;
+    std::vector<vtkIdType> ids;
+
+    void Build ();
+
+public:
+    // der kd-tree enthält nur die punkte von pd innerhalb von bnds
+    SubLocator (vtkPolyData *pd, const double *bnds);
+
+    // wie oben, aber nur aus cands
+    SubLocator (vtkPolyData *pd, const double *bnds, const std::vector<vtkIdType> &cands);
+
+    ~SubLocator ();
+
+    // wie FindPoints, liefert die ids von pd und prüft mit den aktuellen koordinaten
+    void FindPoints (const double *pt, vtkIdList *pts, double tol = 1e-6);
+
+private:
+    SubLocator (const SubLocator&) = delete;
+    SubLocator& operator= (const SubLocator&) = delete;
+};
 
 inline void ComputeNormal2 (vtkPolyData *pd, double *n, vtkIdType num, const vtkIdType *poly) {
     n[0] = 0; n[1] = 0; n[2] = 0;
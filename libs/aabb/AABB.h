@@ -17,22 +17,46 @@ limitations under the License.
 #ifndef __AABB_h
 #define __AABB_h
 
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+#include <cassert>
+
 class BB {
 public:
     BB (double minX, double maxX, double minY, double maxY) : minX(minX), maxX(maxX), minY(minY), maxY(maxY) {}
-    BB () {}
 
-    double GetArea () {
+    // leere box, Extend übernimmt die erste box unverändert
+    BB () : minX(DBL_MAX), maxX(-DBL_MAX), minY(DBL_MAX), maxY(-DBL_MAX) {}
+
+    double GetArea () const {
         return (maxX-minX)*(maxY-minY);
     }
 
-    std::shared_ptr<BB> Merge (const BB &other) {
-        return std::make_shared<BB>(std::min(minX, other.minX),
+    BB Merge (const BB &other) const {
+        return BB(std::min(minX, other.minX),
             std::max(maxX, other.maxX),
             std::min(minY, other.minY),
             std::max(maxY, other.maxY));
     }
 
+    void Extend (const BB &other) {
+        minX = std::min(minX, other.minX);
+        maxX = std::max(maxX, other.maxX);
+        minY = std::min(minY, other.minY);
+        maxY = std::max(maxY, other.maxY);
+    }
+
+    void Extend (double x, double y) {
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
     bool Intersects (const BB &other) const {
         return other.maxX >= minX && other.minX <= maxX
             && other.maxY >= minY && other.minY <= maxY;
@@ -41,20 +65,15 @@ public:
     double minX, maxX, minY, maxY;
 };
 
-class Obj {
+class Line {
 public:
-    virtual BB GetBB () const = 0;
-};
-
-class Line : public Obj {
-public:
-    Line (const Point &a, const Point &b, int grp = NO_USE) : bb{std::min(a.x, b.x),
-        std::max(a.x, b.x),
-        std::min(a.y, b.y),
-        std::max(a.y, b.y)},
+    Line (const Point &a, const Point &b, int grp = NO_USE) : bb{std::min(a.pt[0], b.pt[0]),
+        std::max(a.pt[0], b.pt[0]),
+        std::min(a.pt[1], b.pt[1]),
+        std::max(a.pt[1], b.pt[1])},
         grp(grp), pA(a), pB(b) { }
 
-    virtual BB GetBB () const {
+    const BB& GetBB () const {
         return bb;
     }
 
@@ -69,141 +88,280 @@ public:
     }
 };
 
-class Node {
+// wird in einem stück über ein zusammenhängendes array von objekten aufgebaut
+// T muss GetBB() bereitstellen, objs muss so lange leben wie der baum
+
+template<typename T>
+class AABB {
 public:
-    BB bb;
-    Node (std::shared_ptr<Obj> obj) : obj(obj), left(NO_USE), right(NO_USE), parent(NO_USE) {
-        if (obj) {
-            bb = obj->GetBB();
+    AABB (const std::vector<T> &objs) : objs(objs) {
+        Build();
+    }
+
+    // visit(const T&) wird für jeden treffer aufgerufen, liefert es true, wird abgebrochen
+    template<typename F>
+    bool Search (const BB &bb, F visit) const {
+        if (nodes.empty()) {
+            return false;
         }
+
+        std::uint32_t stack[STACK_SIZE];
+        int top = 0;
+
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node &node = nodes[stack[--top]];
+
+            if (!bb.Intersects(node.bb)) {
+                continue;
+            }
+
+            if (node.num > 0) {
+                for (std::uint32_t i = node.first; i < node.first+node.num; i++) {
+                    const T &obj = objs[order[i]];
+
+                    if (bb.Intersects(obj.GetBB()) && visit(obj)) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[top++] = node.first;
+                stack[top++] = node.first+1;
+            }
+        }
+
+        return false;
     }
 
-    std::shared_ptr<Obj> obj;
-    int left, right, parent;
-};
+    // prüft mehrere boxen in einem durchlauf
+    // bit i in hits wird gesetzt, sobald test(i, obj) für box i true liefert, danach wird box i nicht mehr weiterverfolgt
+    // hits muss (num+63)/64 wörter haben, benachbarte boxen sollten aufeinander folgen
+    template<typename F>
+    void SearchAny (const BB *bbs, std::size_t num, std::uint64_t *hits, F test) const {
+        std::fill_n(hits, (num+63)/64, 0);
 
-class AABB {
-public:
-    AABB () : rootId(NO_USE) {}
+        if (nodes.empty()) {
+            return;
+        }
 
-    void InsertObj (std::shared_ptr<Obj> obj) {
-        int nodeId = CreateNode(obj);
+        struct Item {
+            std::uint32_t id;
+            std::uint64_t active;
+        } stack[STACK_SIZE];
 
-        // std::cout << nodes.at(nodeId).obj.use_count() << std::endl;
+        for (std::size_t off = 0; off < num; off += 64) {
+            const BB *_bbs = bbs+off;
+            std::size_t _num = std::min<std::size_t>(64, num-off);
 
-        if (rootId == NO_USE) {
-            rootId = nodeId;
-        } else {
-            int _id = rootId;
+            std::uint64_t &_hits = hits[off/64],
+                all = _num == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << _num)-1;
 
-            while (nodes[_id].left != NO_USE) {
-                Node &curr = nodes[_id];
+            int top = 0;
 
-                BB bb = *curr.bb.Merge(nodes[nodeId].bb);
+            stack[top++] = {0, all};
 
-                double diff = bb.GetArea()-curr.bb.GetArea();
+            while (top > 0 && _hits != all) {
+                const Item item = stack[--top];
+                const Node &node = nodes[item.id];
 
-                BB bbA = *nodes[curr.left].bb.Merge(nodes[nodeId].bb),
-                    bbB = *nodes[curr.right].bb.Merge(nodes[nodeId].bb);
+                // die noch offenen boxen, die den knoten schneiden
 
-                double cLeft, cRight;
+                std::uint64_t active = 0;
 
-                if (nodes[curr.left].left == NO_USE) {
-                    cLeft = bbA.GetArea()+diff;
-                } else {
-                    cLeft = bbA.GetArea()-nodes[curr.left].bb.GetArea()+diff;
-                }
+                for (std::uint64_t m = item.active & ~_hits; m != 0; m &= m-1) {
+                    int i = Ctz(m);
 
-                if (nodes[curr.right].left == NO_USE) {
-                    cRight = bbB.GetArea()+diff;
-                } else {
-                    cRight = bbB.GetArea()-nodes[curr.right].bb.GetArea()+diff;
+                    if (_bbs[i].Intersects(node.bb)) {
+                        active |= std::uint64_t(1) << i;
+                    }
                 }
 
-                if (bb.GetArea() < cLeft && bb.GetArea() < cRight) {
-                    break;
+                if (active == 0) {
+                    continue;
                 }
 
-                if (cLeft < cRight) {
-                    _id = curr.left;
+                if (node.num > 0) {
+                    for (std::uint32_t j = node.first; j < node.first+node.num && active != 0; j++) {
+                        const T &obj = objs[order[j]];
+
+                        for (std::uint64_t m = active; m != 0; m &= m-1) {
+                            int i = Ctz(m);
+
+                            if (_bbs[i].Intersects(obj.GetBB()) && test(off+i, obj)) {
+                                _hits |= std::uint64_t(1) << i;
+                                active &= ~(std::uint64_t(1) << i);
+                            }
+                        }
+                    }
                 } else {
-                    _id = curr.right;
+                    stack[top++] = {node.first, active};
+                    stack[top++] = {node.first+1, active};
                 }
-
             }
+        }
+    }
+
+private:
+    static int Ctz (std::uint64_t m) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(m);
+#else
+        int i = 0;
+        while ((m & 1) == 0) {
+            m >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
 
-            int parA = nodes[_id].parent;
-            int parB = CreateNode();
+    // innere knoten haben num == 0, ihre kinder liegen bei first und first+1
+    struct Node {
+        BB bb;
+        std::uint32_t first, num;
+    };
 
-            nodes[parB].bb = *nodes[_id].bb.Merge(nodes[nodeId].bb);
+    enum {
+        LEAF_SIZE = 4,
+        NUM_BINS = 16,
+        // ab dieser tiefe wird nur noch halbiert
+        MAX_SAH_DEPTH = 32,
+        STACK_SIZE = 2*MAX_SAH_DEPTH+66
+    };
 
-            nodes[parB].left = _id;
-            nodes[parB].right = nodeId;
-            nodes[parB].parent = parA;
+    const std::vector<T> &objs;
 
-            nodes[_id].parent = parB;
-            nodes[nodeId].parent = parB;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> order;
+    std::vector<double> cents;
 
-            if (parA == NO_USE) {
-                rootId = parB;
-            } else if (nodes[parA].left == _id) {
-                nodes[parA].left = parB;
-            } else {
-                nodes[parA].right = parB;
-            }
+    void Build () {
+        std::uint32_t num = objs.size();
 
-            Update(parA);
+        if (num == 0) {
+            return;
         }
+
+        order.resize(num);
+        std::iota(order.begin(), order.end(), 0);
+
+        cents.resize(2*num);
+
+        for (std::uint32_t i = 0; i < num; i++) {
+            const BB &bb = objs[i].GetBB();
+            cents[2*i] = (bb.minX+bb.maxX)/2;
+            cents[2*i+1] = (bb.minY+bb.maxY)/2;
+        }
+
+        nodes.reserve(2*num);
+        nodes.emplace_back();
+
+        Split(0, 0, num, 0);
+
+        std::vector<double>().swap(cents);
     }
 
-    std::vector<std::shared_ptr<Obj>> Search (std::shared_ptr<Obj> obj) {
-        std::vector<std::shared_ptr<Obj>> found;
+    void Split (std::uint32_t id, std::uint32_t first, std::uint32_t num, int depth) {
+        assert(depth < STACK_SIZE-1);
 
-        std::deque<int> stack{rootId};
+        BB bb, cb;
 
-        const BB &bbA = obj->GetBB();
+        for (std::uint32_t i = first; i < first+num; i++) {
+            const double *c = &cents[2*order[i]];
 
-        while (!stack.empty()) {
-            int s = stack.front();
-            stack.pop_front();
+            bb.Extend(objs[order[i]].GetBB());
+            cb.Extend(c[0], c[1]);
+        }
 
-            if (s == NO_USE) {
-                continue;
-            }
+        nodes[id].bb = bb;
+        nodes[id].first = first;
+        nodes[id].num = num;
 
-            const BB &bbB = nodes[s].bb;
+        if (num <= LEAF_SIZE) {
+            return;
+        }
 
-            if (bbA.Intersects(bbB)) {
-                if (nodes[s].left == NO_USE) {
-                    found.emplace_back(nodes[s].obj);
-                } else {
-                    stack.push_back(nodes[s].left);
-                    stack.push_back(nodes[s].right);
+        int axis = cb.maxX-cb.minX < cb.maxY-cb.minY;
+
+        double lo = axis == 0 ? cb.minX : cb.minY,
+            ext = (axis == 0 ? cb.maxX : cb.maxY)-lo;
+
+        std::uint32_t *beg = order.data()+first,
+            *end = beg+num,
+            *mid = beg+num/2;
+
+        if (ext <= 0) {
+            // alle schwerpunkte fallen zusammen, die reihenfolge ist egal
+
+        } else {
+            bool sah = false;
+
+            if (depth < MAX_SAH_DEPTH) {
+                auto GetBin = [&](std::uint32_t i) {
+                    return std::min<int>(NUM_BINS-1, static_cast<int>((cents[2*i+axis]-lo)/ext*NUM_BINS));
+                };
+
+                BB bins[NUM_BINS];
+                std::uint32_t counts[NUM_BINS] = {};
+
+                for (std::uint32_t *i = beg; i != end; ++i) {
+                    int b = GetBin(*i);
+                    bins[b].Extend(objs[*i].GetBB());
+                    counts[b]++;
                 }
-            }
-        }
 
-        return found;
-    }
+                // kosten der teilung hinter bin i
 
-private:
-    std::vector<Node> nodes;
+                double costs[NUM_BINS-1];
 
-    int rootId;
+                BB acc;
+                std::uint32_t n = 0;
 
-    int CreateNode (std::shared_ptr<Obj> obj = nullptr) {
-        nodes.emplace_back(obj);
-        return nodes.size()-1;
-    }
+                for (int i = 0; i < NUM_BINS-1; i++) {
+                    acc.Extend(bins[i]);
+                    n += counts[i];
+                    costs[i] = n > 0 ? acc.GetArea()*n : 0;
+                }
 
-    void Update (int id) {
-        while (id != NO_USE) {
-            Node &node = nodes[id];
+                acc = BB();
+                n = 0;
 
-            node.bb = *nodes[node.left].bb.Merge(nodes[node.right].bb);
+                for (int i = NUM_BINS-1; i > 0; i--) {
+                    acc.Extend(bins[i]);
+                    n += counts[i];
+                    costs[i-1] += n > 0 ? acc.GetArea()*n : 0;
+                }
 
-            id = node.parent;
+                int best = std::min_element(costs, costs+NUM_BINS-1)-costs;
+
+                mid = std::partition(beg, end, [&](std::uint32_t i) {
+                    return GetBin(i) <= best;
+                });
+
+                sah = mid != beg && mid != end;
+            }
+
+            if (!sah) {
+                mid = beg+num/2;
+
+                std::nth_element(beg, mid, end, [&](std::uint32_t a, std::uint32_t b) {
+                    return cents[2*a+axis] < cents[2*b+axis];
+                });
+            }
         }
+
+        std::uint32_t left = nodes.size(),
+            numLeft = mid-beg;
+
+        nodes.emplace_back();
+        nodes.emplace_back();
+
+        nodes[id].first = left;
+        nodes[id].num = 0;
+
+        Split(left, first, numLeft, depth+1);
+        Split(left+1, first+numLeft, num-numLeft, depth+1);
     }
 };
 
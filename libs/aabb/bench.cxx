@@ -0,0 +1,98 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#include "Tools.h"
+#include "AABB.h"
+
+// misst aufbau und abfragen des baums mit kurzen, zufällig verteilten linien
+
+typedef std::chrono::steady_clock Clock;
+
+double Seconds (const Clock::time_point &start) {
+    return std::chrono::duration<double>(Clock::now()-start).count();
+}
+
+int main () {
+    std::mt19937_64 gen(1);
+    std::uniform_real_distribution<double> pos(0, 100), dir(-.5, .5);
+
+    for (int num : {1000, 10000, 100000}) {
+        std::vector<Line> lines;
+        lines.reserve(num);
+
+        for (int i = 0; i < num; i++) {
+            double x = pos(gen), y = pos(gen);
+            lines.push_back(Line({x, y}, {x+dir(gen), y+dir(gen)}));
+        }
+
+        const int reps = 1000000/num;
+
+        auto start = Clock::now();
+
+        for (int i = 0; i < reps; i++) {
+            AABB<Line> tree(lines);
+        }
+
+        double tBuild = Seconds(start);
+
+        AABB<Line> tree(lines);
+
+        long hits = 0;
+
+        start = Clock::now();
+
+        for (const Line &line : lines) {
+            tree.Search(line.bb, [&hits](const Line &) {
+                hits++;
+                return false;
+            });
+        }
+
+        double tSearch = Seconds(start);
+
+        // dieselben abfragen gebündelt, ein treffer reicht
+
+        std::vector<BB> bbs;
+        bbs.reserve(num);
+
+        for (const Line &line : lines) {
+            bbs.push_back(line.bb);
+        }
+
+        std::vector<std::uint64_t> mask((num+63)/64);
+
+        start = Clock::now();
+
+        tree.SearchAny(bbs.data(), bbs.size(), mask.data(), [](std::size_t, const Line &) {
+            return true;
+        });
+
+        double tAny = Seconds(start);
+
+        std::cout << num << " lines: "
+            << num*reps/tBuild << " inserts/s, "
+            << num/tSearch << " queries/s, "
+            << num/tAny << " batched queries/s, "
+            << static_cast<double>(hits)/num << " hits/query" << std::endl;
+    }
+
+    return 0;
+}
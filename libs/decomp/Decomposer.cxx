@@ -22,7 +22,85 @@ limitations under the License.
 
 #include "Decomposer.h"
 
-void SubP::AddPair (Pair _p, int _w) {
+void PairPool::PushFront (PairList &l, const Pair &p) {
+    int n = nodes.size();
+    nodes.push_back({p, NO_USE, l.first});
+
+    if (l.first != NO_USE) {
+        nodes[l.first].prev = n;
+    } else {
+        l.last = n;
+    }
+
+    l.first = n;
+    l.size++;
+}
+
+void PairPool::PushBack (PairList &l, const Pair &p) {
+    int n = nodes.size();
+    nodes.push_back({p, l.last, NO_USE});
+
+    if (l.last != NO_USE) {
+        nodes[l.last].next = n;
+    } else {
+        l.first = n;
+    }
+
+    l.last = n;
+    l.size++;
+}
+
+Pair PairPool::PopFront (PairList &l) {
+    const Node &n = nodes[l.first];
+
+    l.first = n.next;
+
+    if (l.first != NO_USE) {
+        nodes[l.first].prev = NO_USE;
+    } else {
+        l.last = NO_USE;
+    }
+
+    l.size--;
+
+    return n.p;
+}
+
+Pair PairPool::PopBack (PairList &l) {
+    const Node &n = nodes[l.last];
+
+    l.last = n.prev;
+
+    if (l.last != NO_USE) {
+        nodes[l.last].next = NO_USE;
+    } else {
+        l.first = NO_USE;
+    }
+
+    l.size--;
+
+    return n.p;
+}
+
+void PairPool::Append (PairList &a, PairList &b) {
+    if (b.empty()) {
+        return;
+    }
+
+    if (a.empty()) {
+        a = b;
+    } else {
+        nodes[a.last].next = b.first;
+        nodes[b.first].prev = a.last;
+
+        a.last = b.last;
+        a.size += b.size;
+    }
+
+    b.clear();
+}
+
+void SubP::AddPair (PairPool &pool, Pair _p, int _w) {
     if (_w > w) {
         return;
     }
@@ -33,28 +111,29 @@ void SubP::AddPair (Pair _p, int _w) {
     }
 
     if (!S.empty()) {
-        if (_p.f > S[0].f) {
-            while (!S.empty() && S[0].g >= _p.g) {
+        if (_p.f > pool.Front(S).f) {
+            while (!S.empty() && pool.Front(S).g >= _p.g) {
                 // das neue pair ist im intervall S[0] enthalten
-                S.pop_front();
+                pool.PopFront(S);
             }
         }
     }
 
     // durch einfügen an erster stelle ist S cw-ordered (gegenüber dem polygon)
-    S.insert(S.begin(), _p);
+    pool.PushFront(S, _p);
     w = _w;
 
     S_head.clear();
 
 }
 
-void SubP::RestoreS () {
-    S.insert(S.begin(), S_head.begin(), S_head.end());
-    S.insert(S.end(), S_tail.rbegin(), S_tail.rend());
+void SubP::RestoreS (PairPool &pool) {
+    pool.Append(S_head, S);
+    pool.Append(S_head, S_tail);
+
+    S = S_head;
 
     S_head.clear();
-    S_tail.clear();
 }
 
 Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new SavedPtsType) {
@@ -67,7 +146,15 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
     }
     #endif
 
-    Simplify(orig, savedPts, specTags, poly, NO_USE, false);
+    // die tags entsprechen den indexen, wie in GetVisPoly_wrapper
+    for (auto& p : orig) {
+        p.tag = p.id;
+    }
+
+    // wird auch von allen sichtbarkeitsabfragen verwendet
+    Simplifier simp(orig);
+
+    simp.GetSimplified(savedPts, specTags, poly, NO_USE, false);
 
     std::copy(poly.begin(), poly.end(), std::back_inserter(verts));
 
@@ -86,6 +173,19 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
 
     std::rotate(verts.begin(), first, verts.end());
 
+    int numRefl = 0;
+
+    ranks.assign(num, NO_USE);
+
+    for (int i = 0; i < num; i++) {
+        if (verts[i].refl) {
+            ranks[i] = numRefl++;
+        }
+    }
+
+    slots.assign(numRefl*(num-1), NO_USE);
+    pairs.assign(slots.size(), false);
+
     // indexe der tags bzgl. verts
 
     std::map<int, int> inds;
@@ -99,14 +199,19 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
 
     int ind;
 
+    // die puffer werden für alle reflexen punkte wiederverwendet
+    VisPolyWs ws;
+
+    PolyType vp;
+
     for (itr2 = orig.begin(); itr2 != orig.end(); ++itr2) {
         if (inds.count(itr2->tag) == 1
             && verts[(ind = inds[itr2->tag])].refl) {
 
             int i = itr2-orig.begin();
 
-            PolyType vp;
-            GetVisPoly_wrapper(orig, vp, i);
+            vp.clear();
+            GetVisPoly_wrapper(orig, vp, i, ws, simp);
 
             for (itr3 = vp.begin()+1; itr3 != vp.end(); ++itr3) {
                 if (itr3->id == NO_USE) {
@@ -117,9 +222,11 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
                     int ind2 = inds.at(itr3->tag);
 
                     if (ind < ind2) {
-                        pairs.insert({ind, ind2}); /*std::cout << "add_1 {" << itr2->tag << ", " << itr3->tag << "}" << std::endl;*/
+                        pairs[GetIdx(ind, ind2)] = true; /*std::cout << "add_1 {" << itr2->tag << ", " << itr3->tag << "}" << std::endl;*/
+                        AddSub(ind, ind2);
                     } else {
-                        pairs.insert({ind2, ind}); /*std::cout << "add_2 {" << itr3->tag << ", " << itr2->tag << "}" << std::endl;*/
+                        pairs[GetIdx(ind2, ind)] = true; /*std::cout << "add_2 {" << itr3->tag << ", " << itr2->tag << "}" << std::endl;*/
+                        AddSub(ind2, ind);
                     }
 
                 } catch (...) {}
@@ -157,7 +264,10 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
 
                     //std::cout << "(" << a << ", " << b << ") = ";
 
-                    SubP s;
+                    AddSub(a, b);
+
+                    SubP &s = GetSub(a, b);
+                    s = SubP();
                     s.w = 0;
 
                     if (b-a == 1) {
@@ -166,11 +276,9 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
                         int c = a+1;
                         //std::cout << "wedge" << std::endl;
 
-                        s.S.push_back({c, c});
+                        pool.PushBack(s.S, {c, c});
                     }
 
-                    subs[{a, b}] = std::move(s);
-
                 }
 
             }
@@ -179,6 +287,38 @@ Decomposer::Decomposer (const PolyType &_orig) : orig(_orig), savedPts(new Saved
 
 }
 
+int Decomposer::GetIdx (int i, int k) const {
+    if (verts[i].refl) {
+        return ranks[i]*(num-1)+k-i-1;
+    } else if (verts[k].refl) {
+        return ranks[k]*(num-1)+num-1-k+i;
+    }
+
+    return NO_USE;
+}
+
+bool Decomposer::HasPair (int i, int k) const {
+    int idx = GetIdx(i, k);
+    return idx != NO_USE && pairs[idx];
+}
+
+void Decomposer::AddSub (int i, int k) {
+    int &slot = slots[GetIdx(i, k)];
+
+    if (slot == NO_USE) {
+        slot = subs.size();
+        subs.emplace_back();
+    }
+}
+
+SubP& Decomposer::GetSub (int i, int k) {
+    int idx = GetIdx(i, k);
+
+    vtkbool_throw(idx != NO_USE && slots[idx] != NO_USE, "Decomposer::GetSub", "Unknown pair");
+
+    return subs[slots[idx]];
+}
+
 bool Decomposer::IsRefl (int a, int b, int c) {
     //std::cout << "IsRefl " << a << ", " << b << ", " << c << std::endl;
 
@@ -186,10 +326,10 @@ bool Decomposer::IsRefl (int a, int b, int c) {
         &vB = verts[b],
         &vC = verts[c];
 
-    double n[] = {vB.y-vC.y, vC.x-vB.x};
+    double n[] = {vB.pt[1]-vC.pt[1], vC.pt[0]-vB.pt[0]};
     Normalize(n);
 
-    double d = n[0]*(vA.x-vB.x)+n[1]*(vA.y-vB.y);
+    double d = n[0]*(vA.pt[0]-vB.pt[0])+n[1]*(vA.pt[1]-vB.pt[1]);
 
     return IsNear(vB.pt, vC.pt) || d > 1e-3;
 
@@ -198,39 +338,36 @@ bool Decomposer::IsRefl (int a, int b, int c) {
 void Decomposer::Forw (int i, int j, int k) {
     //std::cout << "Forw " << i << " " << j << " " << k << std::endl;
 
-    Pair p(i, j);
-
-    if (pairs.count(p) == 0) {
+    if (!HasPair(i, j)) {
         return;
     }
 
+    SubP &s = GetSub(i, j);
+
     int a = j;
-    int w = subs[p].w;
+    int w = s.w;
 
     if (k-j > 1) {
-        Pair p_(j, k);
-
-        if (pairs.count(p_) == 0) {
+        if (!HasPair(j, k)) {
             return;
         }
 
-        w += subs[p_].w+1;
+        w += GetSub(j, k).w+1;
     }
 
     if (j-i > 1) {
-        vtkbool_throw(!subs[p].S.empty(), "Decomposer::Forw", "S is empty");
+        vtkbool_throw(!s.S.empty(), "Decomposer::Forw", "S is empty");
 
-        if (!IsRefl(j, k, (subs[p].S.end()-1)->g)) {
-            while (subs[p].S.size() > 1
-                && !IsRefl(j, k, (subs[p].S.end()-2)->g)) {
+        if (!IsRefl(j, k, pool.Back(s.S).g)) {
+            while (s.S.size > 1
+                && !IsRefl(j, k, pool.BeforeBack(s.S).g)) {
 
-                subs[p].S_tail.push_back(subs[p].S.back());
-                subs[p].S.pop_back();
+                pool.PushFront(s.S_tail, pool.PopBack(s.S));
             }
 
-            if (!subs[p].S.empty()
-                && !IsRefl(i, (subs[p].S.end()-1)->f, k)) {
-                a = (subs[p].S.end()-1)->f;
+            if (!s.S.empty()
+                && !IsRefl(i, pool.Back(s.S).f, k)) {
+                a = pool.Back(s.S).f;
             } else {
                 w++;
             }
@@ -240,45 +377,42 @@ void Decomposer::Forw (int i, int j, int k) {
         }
     }
 
-    subs[{i, k}].AddPair({a, j}, w);
+    GetSub(i, k).AddPair(pool, {a, j}, w);
 }
 
 void Decomposer::Backw (int i, int j, int k) {
     //std::cout << "Back " << i << " " << j << " " << k << std::endl;
 
-    Pair p(j, k);
-
-    if (pairs.count(p) == 0) {
+    if (!HasPair(j, k)) {
         return;
     }
 
+    SubP &s = GetSub(j, k);
+
     int a = j;
-    int w = subs[p].w;
+    int w = s.w;
 
     if (j-i > 1) {
-        Pair p_(i, j);
-
-        if (pairs.count(p_) == 0) {
+        if (!HasPair(i, j)) {
             return;
         }
 
-        w += subs[p_].w+1;
+        w += GetSub(i, j).w+1;
     }
 
     if (k-j > 1) {
-        vtkbool_throw(!subs[p].S.empty(), "Decomposer::Backw", "S is empty");
+        vtkbool_throw(!s.S.empty(), "Decomposer::Backw", "S is empty");
 
-        if (!IsRefl(j, (subs[p].S.begin())->f, i)) {
-            while (subs[p].S.size() > 1
-                && !IsRefl(j, (subs[p].S.begin()+1)->f, i)) {
+        if (!IsRefl(j, pool.Front(s.S).f, i)) {
+            while (s.S.size > 1
+                && !IsRefl(j, pool.Second(s.S).f, i)) {
 
-                subs[p].S_head.push_back(subs[p].S.front());
-                subs[p].S.pop_front();
+                pool.PushBack(s.S_head, pool.PopFront(s.S));
             }
 
-            if (!subs[p].S.empty()
-                && !IsRefl(k, i, (subs[p].S.begin())->g)) {
-                a = (subs[p].S.begin())->g;
+            if (!s.S.empty()
+                && !IsRefl(k, i, pool.Front(s.S).g)) {
+                a = pool.Front(s.S).g;
             } else {
                 w++;
             }
@@ -288,7 +422,7 @@ void Decomposer::Backw (int i, int j, int k) {
         }
     }
 
-    subs[{i, k}].AddPair({j, a}, w);
+    GetSub(i, k).AddPair(pool, {j, a}, w);
 }
 
 void Decomposer::Recover (int i, int k) {
@@ -297,24 +431,24 @@ void Decomposer::Recover (int i, int k) {
         return;
     }
 
-    SubP &sA = subs[{i, k}];
+    SubP &sA = GetSub(i, k);
 
     vtkbool_throw(!sA.S.empty(), "Decomposer::Recover", "S is empty");
 
     if (verts[i].refl) {
-        int j = (sA.S.end()-1)->g;
+        int j = pool.Back(sA.S).g;
 
         Recover(j, k);
 
         if (j-i > 1) {
-            if ((sA.S.end()-1)->f != (sA.S.end()-1)->g) {
-                SubP &sB = subs[{i, j}];
-                sB.RestoreS();
+            if (pool.Back(sA.S).f != pool.Back(sA.S).g) {
+                SubP &sB = GetSub(i, j);
+                sB.RestoreS(pool);
 
                 while (!sB.S.empty()
-                    && (sA.S.end()-1)->f != (sB.S.end()-1)->f) {
+                    && pool.Back(sA.S).f != pool.Back(sB.S).f) {
 
-                    sB.S.pop_back();
+                    pool.PopBack(sB.S);
                 }
 
             }
@@ -323,19 +457,19 @@ void Decomposer::Recover (int i, int k) {
         }
 
     } else {
-        int j = (sA.S.begin())->f;
+        int j = pool.Front(sA.S).f;
 
         Recover(i, j);
 
         if (k-j > 1) {
-            if ((sA.S.begin())->f != (sA.S.begin())->g) {
-                SubP &sB = subs[{j, k}];
-                sB.RestoreS();
+            if (pool.Front(sA.S).f != pool.Front(sA.S).g) {
+                SubP &sB = GetSub(j, k);
+                sB.RestoreS(pool);
 
                 while (!sB.S.empty()
-                    && (sA.S.begin())->g != (sB.S.begin())->g) {
+                    && pool.Front(sA.S).g != pool.Front(sB.S).g) {
 
-                    sB.S.pop_front();
+                    pool.PopFront(sB.S);
                 }
             }
 
@@ -351,19 +485,19 @@ void Decomposer::Collect (int i, int k) {
         return;
     }
 
-    SubP &s = subs[{i, k}];
+    SubP &s = GetSub(i, k);
 
     vtkbool_throw(!s.S.empty(), "Decomposer::Collect", "S is empty");
 
     int j, a, b;
 
     if (verts[i].refl) {
-        j = (s.S.end()-1)->g;
-        a = j == (s.S.end()-1)->f;
+        j = pool.Back(s.S).g;
+        a = j == pool.Back(s.S).f;
         b = true;
     } else {
-        j = (s.S.begin())->f;
-        b = j == (s.S.begin())->g;
+        j = pool.Front(s.S).f;
+        b = j == pool.Front(s.S).g;
         a = true;
     }
 
@@ -398,9 +532,7 @@ void Decomposer::GetDecomposed (DecResType &res) {
             if (verts[i].refl) {
                 int k = i+l;
 
-                Pair p(i, k);
-
-                if (pairs.count(p) == 1) {
+                if (HasPair(i, k)) {
                     if (verts[k].refl) {
                         for (int j = i+1; j < k; j++) {
                             Forw(i, j, k);
@@ -423,9 +555,7 @@ void Decomposer::GetDecomposed (DecResType &res) {
             if (verts[k].refl) {
                 int i = k-l;
 
-                Pair p(i, k);
-
-                if (pairs.count(p) == 1) {
+                if (HasPair(i, k)) {
                     if (!verts[i].refl) {
                         Backw(i, i+1, k);
 
@@ -20,10 +20,7 @@ limitations under the License.
 #include <vector>
 #include <iostream>
 #include <set>
-#include <deque>
 #include <map>
-#include <unordered_set>
-#include <unordered_map>
 
 #include "VisPoly.h"
 
@@ -41,41 +38,79 @@ public:
 
 typedef std::vector<Vert6> VertsType6;
 
+// doppelt verkettete liste von pairs, die knoten liegen in PairPool
+
+class PairList {
+public:
+    PairList () : first(NO_USE), last(NO_USE), size(0) {}
+
+    int first, last, size;
+
+    bool empty () const { return size == 0; }
+    void clear () { *this = PairList(); }
+};
+
+class PairPool {
+    class Node {
+    public:
+        Pair p;
+        int prev, next;
+    };
+
+    std::vector<Node> nodes;
+
+public:
+    const Pair& Front (const PairList &l) const { return nodes[l.first].p; }
+    const Pair& Back (const PairList &l) const { return nodes[l.last].p; }
+
+    // zweites und vorletztes element
+    const Pair& Second (const PairList &l) const { return nodes[nodes[l.first].next].p; }
+    const Pair& BeforeBack (const PairList &l) const { return nodes[nodes[l.last].prev].p; }
+
+    void PushFront (PairList &l, const Pair &p);
+    void PushBack (PairList &l, const Pair &p);
+
+    Pair PopFront (PairList &l);
+    Pair PopBack (PairList &l);
+
+    // hängt b an a an, b ist danach leer
+    void Append (PairList &a, PairList &b);
+};
+
 class SubP {
 public:
     SubP () : w(99999) {}
 
-    void AddPair (Pair _p, int _w);
-    void RestoreS ();
+    void AddPair (PairPool &pool, Pair _p, int _w);
+    void RestoreS (PairPool &pool);
 
     int w;
-    std::deque<Pair> S, S_head, S_tail;
+
+    // S_tail ist umgekehrt gespeichert
+    PairList S, S_head, S_tail;
 };
 
 typedef std::vector<IdsType> DecResType;
 
-// siehe boost
-template<typename T> void hash_combine (std::size_t &seed, T const &v) {
-    seed ^= std::hash<T>{}(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-}
-
-struct p_h {
-    std::size_t operator () (const Pair& p) const {
-        std::size_t seed = 0;
-        hash_combine(seed, p.f);
-        hash_combine(seed, p.g);
-        return seed;
-    }
-};
-
 class Decomposer {
     PolyType orig, poly;
     VertsType6 verts;
 
     int num;
 
-    std::unordered_set<Pair, p_h> pairs;
-    std::unordered_map<Pair, SubP, p_h> subs;
+    // jeder reflexe punkt hat eine zeile aus num-1 einträgen,
+    // vorne die pairs zu den folgenden punkten, hinten die zu den vorherigen, nicht reflexen
+
+    IdsType ranks, slots;
+    std::vector<bool> pairs;
+
+    std::vector<SubP> subs;
+    PairPool pool;
+
+    int GetIdx (int i, int k) const;
+    bool HasPair (int i, int k) const;
+    SubP& GetSub (int i, int k);
+    void AddSub (int i, int k);
 
     bool IsRefl (int a, int b, int c);
 
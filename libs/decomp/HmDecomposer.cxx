@@ -0,0 +1,581 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <map>
+
+#include "HmDecomposer.h"
+
+enum class VertType {
+    START,
+    END,
+    SPLIT,
+    MERGE,
+    REGULAR
+};
+
+bool IsFlat (const double *a, const double *b, const double *c) {
+    // abstand von b zur geraden durch a und c
+
+    double v[] = {c[0]-a[0], c[1]-a[1]},
+        l = std::sqrt(v[0]*v[0]+v[1]*v[1]);
+
+    if (l < E) {
+        return true;
+    }
+
+    return std::abs(v[0]*(b[1]-a[1])-v[1]*(b[0]-a[0]))/l < E;
+}
+
+HmDecomposer::HmDecomposer (const PolyType &_orig) : orig(_orig), cw(TestCW(_orig)), num(0), sweepY(0), sweepX(0) {
+    int n = orig.size();
+
+    // die zerlegung arbeitet ccw
+
+    for (int i = 0; i < n; i++) {
+        seq.push_back(cw ? n-1-i : i);
+    }
+
+    auto P = [&](int i) {
+        return orig[seq[i]].pt;
+    };
+
+    IdsType keep;
+
+    for (int i = 0; i < n; i++) {
+        if (!keep.empty() && IsNear(P(keep.back()), P(i))) {
+            continue;
+        }
+
+        keep.push_back(i);
+
+        while (keep.size() > 2 && IsFlat(P(*(keep.end()-3)), P(*(keep.end()-2)), P(keep.back()))) {
+            keep.erase(keep.end()-2);
+        }
+    }
+
+    // übergang vom ende zum anfang
+
+    while (keep.size() > 2) {
+        if (IsNear(P(keep.back()), P(keep.front()))
+            || IsFlat(P(*(keep.end()-2)), P(keep.back()), P(keep.front()))) {
+
+            keep.pop_back();
+        } else if (IsFlat(P(keep.back()), P(keep.front()), P(keep[1]))) {
+            keep.erase(keep.begin());
+        } else {
+            break;
+        }
+    }
+
+    for (int i : keep) {
+        inds.push_back(seq[i]);
+    }
+
+    pos.swap(keep);
+
+    num = inds.size();
+}
+
+bool HmDecomposer::Above (int a, int b) {
+    const double *pA = Pt(a),
+        *pB = Pt(b);
+
+    return pA[1] > pB[1] || (pA[1] == pB[1] && pA[0] < pB[0]);
+}
+
+bool HmDecomposer::IsConvex (int a, int b, int c) {
+    return Cross(Pt(a), Pt(b), Pt(c)) < 0;
+}
+
+bool HmDecomposer::IsRefl (int a, int b, int c) {
+    return Cross(Pt(a), Pt(b), Pt(c)) > 0;
+}
+
+double HmDecomposer::GetX (int e) {
+    if (e == NO_USE) {
+        return sweepX;
+    }
+
+    const double *a = Pt(e),
+        *b = Pt(Next(e));
+
+    if (a[1] == b[1]) {
+        // waagerechte kanten sind nur auf der höhe ihres oberen punktes im status
+        return sweepX;
+    }
+
+    double t = (sweepY-a[1])/(b[1]-a[1]);
+
+    return a[0]+t*(b[0]-a[0]);
+}
+
+bool HmDecomposer::Cmp::operator() (int eA, int eB) const {
+    if (eA == eB) {
+        return false;
+    }
+
+    double xA = d->GetX(eA),
+        xB = d->GetX(eB);
+
+    if (xA != xB) {
+        return xA < xB;
+    }
+
+    return eA < eB;
+}
+
+void HmDecomposer::GetDiags (std::vector<Pair> &diags) {
+    // unterteilung in y-monotone polygone, siehe de Berg et al., kap. 3.2
+
+    std::vector<VertType> types(num);
+
+    for (int i = 0; i < num; i++) {
+        bool a = Above(i, Prev(i)),
+            b = Above(i, Next(i));
+
+        if (a && b) {
+            types[i] = IsRefl(Prev(i), i, Next(i)) ? VertType::SPLIT : VertType::START;
+        } else if (!a && !b) {
+            types[i] = IsRefl(Prev(i), i, Next(i)) ? VertType::MERGE : VertType::END;
+        } else {
+            types[i] = VertType::REGULAR;
+        }
+    }
+
+    IdsType order(num);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return Above(a, b);
+    });
+
+    // die kante i geht von i nach Next(i), im status sind nur kanten mit dem inneren rechts davon
+
+    StatusType status(Cmp{this});
+
+    std::vector<StatusType::iterator> itrs(num, status.end());
+    IdsType helper(num, NO_USE);
+
+    auto Left = [&]() {
+        auto itr = status.lower_bound(NO_USE);
+
+        vtkbool_throw(itr != status.begin(), "HmDecomposer::GetDiags", "No left edge");
+
+        return *(--itr);
+    };
+
+    auto AddDiag = [&](int i, int j) {
+        if (j != NO_USE && types[j] == VertType::MERGE) {
+            diags.emplace_back(i, j);
+        }
+    };
+
+    for (int i : order) {
+        const double *pt = Pt(i);
+
+        sweepX = pt[0];
+        sweepY = pt[1];
+
+        int p = Prev(i),
+            j;
+
+        switch (types[i]) {
+            case VertType::START:
+                itrs[i] = status.insert(i).first;
+                helper[i] = i;
+                break;
+
+            case VertType::END:
+                AddDiag(i, helper[p]);
+                status.erase(itrs[p]);
+                break;
+
+            case VertType::SPLIT:
+                j = Left();
+                diags.emplace_back(i, helper[j]);
+                helper[j] = i;
+
+                itrs[i] = status.insert(i).first;
+                helper[i] = i;
+                break;
+
+            case VertType::MERGE:
+                AddDiag(i, helper[p]);
+                status.erase(itrs[p]);
+
+                j = Left();
+                AddDiag(i, helper[j]);
+                helper[j] = i;
+                break;
+
+            case VertType::REGULAR:
+                if (Above(p, i)) {
+                    // das innere liegt rechts
+                    AddDiag(i, helper[p]);
+                    status.erase(itrs[p]);
+
+                    itrs[i] = status.insert(i).first;
+                    helper[i] = i;
+                } else {
+                    j = Left();
+                    AddDiag(i, helper[j]);
+                    helper[j] = i;
+                }
+                break;
+        }
+    }
+}
+
+void HmDecomposer::GetMonotones (const std::vector<Pair> &diags, std::vector<IdsType> &monos) {
+    if (diags.empty()) {
+        IdsType mono(num);
+        std::iota(mono.begin(), mono.end(), 0);
+
+        monos.push_back(mono);
+
+        return;
+    }
+
+    std::vector<IdsType> adjs(num);
+
+    for (int i = 0; i < num; i++) {
+        adjs[i] = {Prev(i), Next(i)};
+    }
+
+    for (auto &d : diags) {
+        adjs[d.f].push_back(d.g);
+        adjs[d.g].push_back(d.f);
+    }
+
+    for (int i = 0; i < num; i++) {
+        IdsType &adj = adjs[i];
+
+        if (adj.size() > 2) {
+            const double *a = Pt(i);
+
+            std::vector<double> angs;
+
+            for (int j : adj) {
+                const double *b = Pt(j);
+                angs.push_back(std::atan2(b[1]-a[1], b[0]-a[0]));
+            }
+
+            IdsType order(adj.size());
+            std::iota(order.begin(), order.end(), 0);
+
+            std::sort(order.begin(), order.end(), [&angs](int a, int b) {
+                return angs[a] < angs[b];
+            });
+
+            IdsType _adj;
+
+            for (int k : order) {
+                _adj.push_back(adj[k]);
+            }
+
+            adj.swap(_adj);
+        }
+    }
+
+    std::set<Pair> used;
+
+    int maxSteps = num+2*diags.size();
+
+    auto Walk = [&](int u, int v) {
+        if (used.count({u, v}) == 1) {
+            return;
+        }
+
+        IdsType mono;
+
+        const int u0 = u,
+            v0 = v;
+
+        do {
+            vtkbool_throw(mono.size() < maxSteps, "HmDecomposer::GetMonotones", "Invalid face");
+
+            mono.push_back(u);
+            used.emplace(u, v);
+
+            // die nachfolgende kante ist die nächste im uhrzeigersinn nach v->u
+
+            const IdsType &adj = adjs[v];
+
+            auto itr = std::find(adj.begin(), adj.end(), u);
+
+            int w = itr == adj.begin() ? adj.back() : *(itr-1);
+
+            u = v;
+            v = w;
+
+        } while (u != u0 || v != v0);
+
+        monos.push_back(mono);
+    };
+
+    for (int i = 0; i < num; i++) {
+        Walk(i, Next(i));
+    }
+
+    for (auto &d : diags) {
+        Walk(d.f, d.g);
+        Walk(d.g, d.f);
+    }
+}
+
+void HmDecomposer::Triangulate (const IdsType &mono, std::vector<IdsType> &tris) {
+    // siehe de Berg et al., kap. 3.3
+
+    int m = mono.size();
+
+    auto AddTri = [&](int a, int b, int c) {
+        a = mono[a];
+        b = mono[b];
+        c = mono[c];
+
+        if (IsRefl(a, b, c)) {
+            std::swap(b, c);
+        }
+
+        tris.push_back({a, b, c});
+    };
+
+    if (m == 3) {
+        AddTri(0, 1, 2);
+        return;
+    }
+
+    int top = 0,
+        bot = 0;
+
+    for (int i = 1; i < m; i++) {
+        if (Above(mono[i], mono[top])) {
+            top = i;
+        }
+        if (Above(mono[bot], mono[i])) {
+            bot = i;
+        }
+    }
+
+    // von oben nach unten ist ccw die linke kette
+
+    std::vector<bool> left(m, false);
+
+    for (int i = top; i != bot; i = (i+1)%m) {
+        left[i] = true;
+    }
+
+    IdsType order(m);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return Above(mono[a], mono[b]);
+    });
+
+    IdsType st {order[0], order[1]};
+
+    for (int j = 2; j < m-1; j++) {
+        int u = order[j];
+
+        if (left[u] != left[st.back()]) {
+            for (int k = 0; k+1 < st.size(); k++) {
+                AddTri(u, st[k], st[k+1]);
+            }
+
+            st = {order[j-1], u};
+
+        } else {
+            int last = st.back();
+            st.pop_back();
+
+            while (!st.empty()) {
+                int t = st.back();
+
+                bool inside = left[u]
+                    ? IsConvex(mono[t], mono[last], mono[u])
+                    : IsConvex(mono[u], mono[last], mono[t]);
+
+                if (!inside) {
+                    break;
+                }
+
+                AddTri(u, last, t);
+
+                last = t;
+                st.pop_back();
+            }
+
+            st.push_back(last);
+            st.push_back(u);
+        }
+    }
+
+    int u = order[m-1];
+
+    for (int k = 0; k+1 < st.size(); k++) {
+        AddTri(u, st[k], st[k+1]);
+    }
+}
+
+void HmDecomposer::Merge (const std::vector<IdsType> &tris, std::vector<IdsType> &decs) {
+    // halbkanten der dreiecke
+
+    int numH = 3*tris.size();
+
+    IdsType from(numH), to(numH), next(numH), prev(numH), twin(numH, NO_USE);
+
+    std::map<Pair, int> edges;
+
+    for (int i = 0; i < tris.size(); i++) {
+        for (int k = 0; k < 3; k++) {
+            int h = 3*i+k;
+
+            from[h] = tris[i][k];
+            to[h] = tris[i][(k+1)%3];
+            next[h] = 3*i+(k+1)%3;
+            prev[h] = 3*i+(k+2)%3;
+
+            edges.emplace(Pair(from[h], to[h]), h);
+        }
+    }
+
+    for (int h = 0; h < numH; h++) {
+        auto itr = edges.find(Pair(to[h], from[h]));
+
+        if (itr != edges.end()) {
+            twin[h] = itr->second;
+        }
+    }
+
+    // eine diagonale ist überflüssig, wenn ihre beiden enden ohne sie konvex bleiben
+
+    std::vector<bool> rm(numH, false);
+
+    for (int h = 0; h < numH; h++) {
+        int t = twin[h];
+
+        if (t < h) {
+            continue;
+        }
+
+        if (IsRefl(from[prev[h]], from[h], to[next[t]])
+            || IsRefl(from[prev[t]], from[t], to[next[h]])) {
+
+            continue;
+        }
+
+        next[prev[h]] = next[t];
+        prev[next[t]] = prev[h];
+
+        next[prev[t]] = next[h];
+        prev[next[h]] = prev[t];
+
+        rm[h] = true;
+        rm[t] = true;
+    }
+
+    std::vector<bool> visited(numH, false);
+
+    for (int h = 0; h < numH; h++) {
+        if (rm[h] || visited[h]) {
+            continue;
+        }
+
+        IdsType dec;
+
+        int e = h;
+
+        do {
+            visited[e] = true;
+            dec.push_back(from[e]);
+
+            e = next[e];
+        } while (e != h);
+
+        decs.push_back(dec);
+    }
+}
+
+void HmDecomposer::GetDecomposed (DecResType &res) {
+    bool refl = false;
+
+    for (int i = 0; i < num && !refl; i++) {
+        refl = IsRefl(Prev(i), i, Next(i));
+    }
+
+    if (!refl) {
+        // schon konvex
+
+        IdsType ids;
+
+        for (auto &p : orig) {
+            ids.push_back(p.id);
+        }
+
+        res.push_back(ids);
+
+        return;
+    }
+
+    std::vector<Pair> diags;
+    GetDiags(diags);
+
+    std::vector<IdsType> monos;
+    GetMonotones(diags, monos);
+
+    std::vector<IdsType> tris;
+
+    for (auto &mono : monos) {
+        Triangulate(mono, tris);
+    }
+
+    std::vector<IdsType> decs;
+    Merge(tris, decs);
+
+    int n = seq.size();
+
+    for (auto &dec : decs) {
+        IdsType ids;
+
+        for (int i = 0; i < dec.size(); i++) {
+            int k = dec[i],
+                l = dec[(i+1)%dec.size()];
+
+            ids.push_back(inds[k]);
+
+            if (l == Next(k)) {
+                // die entfernten punkte wiederherstellen
+                for (int q = (pos[k]+1)%n; q != pos[l]; q = (q+1)%n) {
+                    ids.push_back(seq[q]);
+                }
+            }
+        }
+
+        if (cw) {
+            std::reverse(ids.begin(), ids.end());
+        }
+
+        for (int &id : ids) {
+            id = orig[id].id;
+        }
+
+        res.push_back(ids);
+    }
+
+}
@@ -27,8 +27,6 @@ limitations under the License.
 #include "Decomposer.h"
 #include "Tools.h"
 
-int Point::_tag = 0;
-
 void ToPoly (const Json::Value& pts, PolyType &poly) {
     int i = 0;
 
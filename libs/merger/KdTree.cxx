@@ -0,0 +1,133 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <numeric>
+
+#include "Tools.h"
+#include "KdTree.h"
+
+KdTree::KdTree (const std::vector<double> &pts) : pts(pts) {
+    std::uint32_t num = pts.size()/2;
+
+    if (num == 0) {
+        return;
+    }
+
+    order.resize(num);
+    std::iota(order.begin(), order.end(), 0);
+
+    nodes.reserve(2*num/LEAF_SIZE+2);
+    nodes.emplace_back();
+
+    Split(0, 0, num);
+}
+
+void KdTree::Split (std::uint32_t id, std::uint32_t first, std::uint32_t num) {
+    Node node = {DBL_MAX, -DBL_MAX, DBL_MAX, -DBL_MAX, first, num};
+
+    for (std::uint32_t i = first; i < first+num; i++) {
+        const double *p = &pts[2*order[i]];
+
+        node.minX = std::min(node.minX, p[0]);
+        node.maxX = std::max(node.maxX, p[0]);
+        node.minY = std::min(node.minY, p[1]);
+        node.maxY = std::max(node.maxY, p[1]);
+    }
+
+    nodes[id] = node;
+
+    if (num <= LEAF_SIZE) {
+        return;
+    }
+
+    // halbiert entlang der längeren seite
+
+    int axis = node.maxX-node.minX < node.maxY-node.minY;
+
+    std::uint32_t *beg = order.data()+first,
+        *mid = beg+num/2;
+
+    std::nth_element(beg, mid, beg+num, [&](std::uint32_t a, std::uint32_t b) {
+        return pts[2*a+axis] < pts[2*b+axis];
+    });
+
+    std::uint32_t left = nodes.size();
+
+    nodes.emplace_back();
+    nodes.emplace_back();
+
+    nodes[id].first = left;
+    nodes[id].num = 0;
+
+    Split(left, first, num/2);
+    Split(left+1, first+num/2, num-num/2);
+}
+
+KdTree::Iter::Iter (const KdTree &tree, const double *_pt) : tree(&tree) {
+    Cpy(pt, _pt);
+
+    if (!tree.nodes.empty()) {
+        Push(0, 0);
+    }
+}
+
+void KdTree::Iter::Push (double d, std::int64_t ref) {
+    heap.push_back({d, ref});
+    std::push_heap(heap.begin(), heap.end());
+}
+
+int KdTree::Iter::Next () {
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+
+        const Entry e = heap.back();
+        heap.pop_back();
+
+        if (e.ref < 0) {
+            return static_cast<int>(~e.ref);
+        }
+
+        const Node &node = tree->nodes[e.ref];
+
+        if (node.num > 0) {
+            for (std::uint32_t i = node.first; i < node.first+node.num; i++) {
+                std::uint32_t j = tree->order[i];
+
+                const double *p = &tree->pts[2*j];
+
+                double dx = p[0]-pt[0],
+                    dy = p[1]-pt[1];
+
+                Push(dx*dx+dy*dy, ~static_cast<std::int64_t>(j));
+            }
+
+        } else {
+            for (std::uint32_t c = node.first; c < node.first+2; c++) {
+                const Node &child = tree->nodes[c];
+
+                // abstand zur box
+
+                double dx = std::max(0., std::max(child.minX-pt[0], pt[0]-child.maxX)),
+                    dy = std::max(0., std::max(child.minY-pt[1], pt[1]-child.maxY));
+
+                Push(dx*dx+dy*dy, c);
+            }
+        }
+    }
+
+    return NO_USE;
+}
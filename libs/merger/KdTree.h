@@ -0,0 +1,73 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __KdTree_h
+#define __KdTree_h
+
+#include <vector>
+#include <cstdint>
+
+// 2d kd-baum über ein zusammenhängendes array von koordinaten (x0, y0, x1, y1, ...)
+// pts muss so lange leben wie der baum
+
+class KdTree {
+    struct Node {
+        double minX, maxX, minY, maxY;
+        std::uint32_t first, num;
+    };
+
+    enum {
+        LEAF_SIZE = 8
+    };
+
+    const std::vector<double> &pts;
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> order;
+
+    void Split (std::uint32_t id, std::uint32_t first, std::uint32_t num);
+
+public:
+    KdTree (const std::vector<double> &pts);
+
+    // liefert die punkte nach aufsteigendem abstand, jeder aufruf von Next() setzt die suche fort
+    class Iter {
+        struct Entry {
+            double d;
+            // punkte sind mit ~id kodiert
+            std::int64_t ref;
+
+            bool operator< (const Entry &other) const {
+                return d > other.d || (d == other.d && ref > other.ref);
+            }
+        };
+
+        const KdTree *tree;
+        double pt[2];
+
+        std::vector<Entry> heap;
+
+        void Push (double d, std::int64_t ref);
+
+    public:
+        Iter (const KdTree &tree, const double *pt);
+
+        // NO_USE, wenn alle punkte geliefert wurden
+        int Next ();
+    };
+};
+
+#endif
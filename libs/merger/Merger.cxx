@@ -24,42 +24,72 @@ limitations under the License.
 #include <deque>
 #include <string>
 #include <sstream>
-
-#include <vtkIdList.h>
-#include <vtkPoints.h>
-#include <vtkKdTree.h>
-#include <vtkMath.h>
+#include <cmath>
 
 #include "Tools.h"
 #include "AABB.h"
+#include "KdTree.h"
+
+class PolyBB {
+public:
+    BB bb;
+    int id;
+
+    const BB& GetBB () const {
+        return bb;
+    }
+};
 
 void Merger::AddPoly (PolyType &poly) {
     polys.push_back(poly);
 }
 
-void Merger::GetMerged (PolysType &res) {
+void Merger::GetNesting (std::vector<IdsType> &all) {
 
     int numPolys = polys.size();
 
-    std::vector<IdsType> all(numPolys);
+    all.assign(numPolys, IdsType());
+
+    // liegt der punkt außerhalb der bounding box, liefert TestPip immer false
+    // daher werden nur die polygone getestet, deren box den punkt enthält
+
+    std::vector<PolyBB> bbs;
+    bbs.reserve(numPolys);
 
     for (int i = 0; i < numPolys; i++) {
-        IdsType outer;
+        BB bb;
 
-        for (int j = 0; j < numPolys; j++) {
-            if (i != j) {
-                if (TestPip(polys[j], polys[i][0])) {
-                    outer.push_back(j);
-                }
-            }
+        for (const Point &p : polys[i]) {
+            bb.Extend(p.pt[0], p.pt[1]);
         }
 
-        for (int j : outer) {
-            all[j].push_back(i);
-        }
+        bbs.push_back({bb, i});
+    }
+
+    AABB<PolyBB> tree(bbs);
+
+    for (int i = 0; i < numPolys; i++) {
+        Point &pt = polys[i][0];
+
+        tree.Search(BB(pt.pt[0], pt.pt[0], pt.pt[1], pt.pt[1]), [&](const PolyBB &p) {
+            int j = p.id;
+
+            if (i != j && TestPip(polys[j], pt)) {
+                all[j].push_back(i);
+            }
+
+            return false;
+        });
 
     }
 
+}
+
+void Merger::GetMerged (PolysType &res) {
+
+    std::vector<IdsType> all;
+    GetNesting(all);
+
     //std::vector<IdsType> all = {{2}, {}, {1, 3}, {}, {0}};
 
     int i = 0;
@@ -114,9 +144,10 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
 
     std::map<int, int> oldPtIds;
 
-    vtkPoints *pts = vtkPoints::New();
+    // x0, y0, x1, y1, ...
+    std::vector<double> pts;
 
-    AABB treeA;
+    std::vector<Line> lines;
 
     PolyType::iterator itr, itr2;
 
@@ -131,7 +162,8 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
 
             src.push_back(b);
 
-            pts->InsertNextPoint(itr->x, itr->y, 0);
+            pts.push_back(itr->pt[0]);
+            pts.push_back(itr->pt[1]);
         }
 
         for (itr = poly.begin(); itr != poly.end(); ++itr) {
@@ -141,96 +173,101 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
                 itr2 = poly.begin();
             }
 
-            std::shared_ptr<Line> line(new Line({*itr}, {*itr2}));
-
-            treeA.InsertObj(line);
+            lines.push_back(Line({*itr}, {*itr2}));
         }
 
         b++;
     }
 
-    vtkKdTree *treeB = vtkKdTree::New();
-    treeB->OmitZPartitioning();
-    treeB->BuildLocatorFromPoints(pts);
+    AABB<Line> treeA(lines);
 
-    int numPts = pts->GetNumberOfPoints();
+    KdTree treeB(pts);
+
+    int numPts = a;
+
+    // jeder punkt setzt seine suche nach nachbarn in der nächsten runde fort
+
+    std::vector<KdTree::Iter> nearest;
+    nearest.reserve(numPts);
+
+    for (int i = 0; i < numPts; i++) {
+        nearest.emplace_back(treeB, &pts[2*i]);
+    }
 
     const Bnds bnds(-E, E, -E, E);
 
     IdsType ids(numPts);
     std::iota(ids.begin(), ids.end(), 0);
 
-    int curr = 1;
-
     ResType res;
 
     std::vector<Pair> cons;
 
-    while (!ids.empty()) {
-        for (int idA : ids) {
-            double ptA[3],
-                ptB[3];
-
-            pts->GetPoint(idA, ptA);
+    // kandidaten einer runde, werden gesammelt gegen den baum geprüft
 
-            vtkIdList *cls = vtkIdList::New();
-            treeB->FindClosestNPoints(curr*2, ptA, cls);
+    std::vector<Pair> cands;
+    std::vector<BB> bbs;
+    std::vector<std::uint64_t> hits;
 
-            int numCls = cls->GetNumberOfIds();
+    while (!ids.empty()) {
+        cands.clear();
+        bbs.clear();
 
-            // sucht nach gültigen verbindungen
+        for (int idA : ids) {
+            const double *ptA = &pts[2*idA];
 
-            std::vector<int> _ids;
+            // sucht nach gültigen verbindungen unter den nächsten zwei punkten
 
             int srcA = src[idA];
 
-            for (int i = (curr-1)*2; i < numCls; i++) {
-                int idB = cls->GetId(i),
-                    srcB = src[idB];
+            for (int i = 0; i < 2; i++) {
+                int idB = nearest[idA].Next();
 
-                if (srcA != srcB) {
-                    _ids.push_back(idB);
+                if (idB == NO_USE) {
+                    break;
                 }
-            }
-
-            _ids.erase(std::remove_if(_ids.begin(), _ids.end(), [&](int idB) {
-                pts->GetPoint(idB, ptB);
-
-                std::shared_ptr<Line> lineA(new Line({ptA}, {ptB}));
 
-                auto found = treeA.Search(lineA);
+                if (srcA != src[idB]) {
+                    const double *ptB = &pts[2*idB];
 
-                for (auto &f : found) {
-                    Line &lineB = dynamic_cast<Line&>(*f);
+                    cands.emplace_back(idA, idB);
+                    bbs.emplace_back(std::min(ptA[0], ptB[0]), std::max(ptA[0], ptB[0]), std::min(ptA[1], ptB[1]), std::max(ptA[1], ptB[1]));
+                }
+            }
+        }
 
-                    if (lineB.pA.id != idA && lineB.pB.id != idA
-                        && lineB.pA.id != idB && lineB.pB.id != idB
-                        && Intersect2(ptA, ptB, lineB.pA.pt, lineB.pB.pt, bnds)) {
+        hits.resize((cands.size()+63)/64);
 
-                        return true;
-                    }
-                }
+        treeA.SearchAny(bbs.data(), bbs.size(), hits.data(), [&](std::size_t i, const Line &lineB) {
+            int idA = cands[i].f,
+                idB = cands[i].g;
 
-                return false;
+            const double *ptA = &pts[2*idA],
+                *ptB = &pts[2*idB];
 
-            }), _ids.end());
+            return lineB.pA.id != idA && lineB.pB.id != idA
+                && lineB.pA.id != idB && lineB.pB.id != idB
+                && Intersect2(ptA, ptB, lineB.pA.pt, lineB.pB.pt, bnds);
+        });
 
-            for (int idB : _ids) {
-                pts->GetPoint(idB, ptB);
+        for (std::size_t i = 0; i < cands.size(); i++) {
+            if (hits[i/64] & (std::uint64_t(1) << (i%64))) {
+                continue;
+            }
 
-                double v[3];
-                vtkMath::Subtract(ptA, ptB, v);
+            int idA = cands[i].f,
+                idB = cands[i].g;
 
-                double d = vtkMath::Norm(v);
+            const double *ptA = &pts[2*idA],
+                *ptB = &pts[2*idB];
 
-                int pA = src[idA],
-                    pB = src[idB];
+            double d = std::hypot(ptB[0]-ptA[0], ptB[1]-ptA[1]);
 
-                res[pA].emplace(Pair(idA, idB), d);
-                res[pB].emplace(Pair(idB, idA), d);
-            }
+            int pA = src[idA],
+                pB = src[idB];
 
-            cls->Delete();
+            res[pA].emplace(Pair(idA, idB), d);
+            res[pB].emplace(Pair(idB, idA), d);
         }
 
         ids.clear();
@@ -291,8 +328,6 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
 
                 // std::cout << "]" << std::endl;
 
-                curr++;
-
                 break;
             }
         }
@@ -315,8 +350,7 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
     auto FindId = [&](PolyTypeD &poly, int id, int end, int s) -> PolyTypeD::iterator {
         PolyTypeD::iterator itr;
 
-        double pt[3];
-        pts->GetPoint(end, pt);
+        const double *pt = &pts[2*end];
 
         int num = poly.size();
 
@@ -324,7 +358,7 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
             if (itr->id == id) {
                 int i = itr-poly.begin();
 
-                double v[] = {pt[0]-itr->x, pt[1]-itr->y};
+                double v[] = {pt[0]-itr->pt[0], pt[1]-itr->pt[1]};
                 Normalize(v);
 
                 int iA = (i+1)%num,
@@ -333,8 +367,8 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
                 Point &pA = poly[iA],
                     &pB = poly[iB];
 
-                double wA[] = {pA.x-itr->x, pA.y-itr->y},
-                    wB[] = {pB.x-itr->x, pB.y-itr->y};
+                double wA[] = {pA.pt[0]-itr->pt[0], pA.pt[1]-itr->pt[1]},
+                    wB[] = {pB.pt[0]-itr->pt[0], pB.pt[1]-itr->pt[1]};
 
                 Normalize(wA);
                 Normalize(wB);
@@ -442,7 +476,4 @@ void Merger::Merge (PolysType &group, PolyType &merged) {
 
     assert(!TestCW(merged));
 
-    treeB->Delete();
-    pts->Delete();
-
 }
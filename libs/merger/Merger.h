@@ -42,6 +42,10 @@ class Merger {
 public:
     Merger () {}
     void AddPoly (PolyType &poly);
+
+    // all[i] enthält die polygone, deren erster punkt in polygon i liegt
+    void GetNesting (std::vector<IdsType> &all);
+
     void GetMerged (PolysType &res);
 };
 
@@ -0,0 +1,114 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+
+#include "Tools.h"
+#include "Merger.h"
+
+// lochplatte mit rows*cols kreisförmigen löchern
+
+typedef std::chrono::steady_clock Clock;
+
+double Millis (const Clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(Clock::now()-start).count();
+}
+
+void MakePlate (int rows, int cols, PolysType &polys) {
+    const int n = 16;
+
+    int id = 0;
+
+    PolyType outer;
+
+    outer.push_back(Point(0, 0, id++));
+    outer.push_back(Point(cols*3, 0, id++));
+    outer.push_back(Point(cols*3, rows*3, id++));
+    outer.push_back(Point(0, rows*3, id++));
+
+    polys.push_back(outer);
+
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            PolyType hole;
+
+            for (int k = 0; k < n; k++) {
+                double phi = 2*PI*k/n;
+                hole.push_back(Point(j*3+1.5+std::cos(phi), i*3+1.5+std::sin(phi), id++));
+            }
+
+            polys.push_back(hole);
+        }
+    }
+}
+
+int main () {
+    const int sizes[][2] = {{10, 10}, {20, 20}, {25, 40}};
+
+    for (auto &size : sizes) {
+        PolysType polys;
+        MakePlate(size[0], size[1], polys);
+
+        int numPolys = polys.size();
+
+        // bisherige verschachtelung zum vergleich, mit derselben ausgabe wie GetNesting
+
+        auto start = Clock::now();
+
+        std::vector<IdsType> pairwise(numPolys);
+
+        for (int i = 0; i < numPolys; i++) {
+            for (int j = 0; j < numPolys; j++) {
+                if (i != j && TestPip(polys[j], polys[i][0])) {
+                    pairwise[j].push_back(i);
+                }
+            }
+        }
+
+        double tPip = Millis(start);
+
+        Merger m;
+
+        for (auto &poly : polys) {
+            m.AddPoly(poly);
+        }
+
+        std::vector<IdsType> nesting;
+
+        start = Clock::now();
+
+        m.GetNesting(nesting);
+
+        double tTree = Millis(start);
+
+        PolysType merged;
+
+        start = Clock::now();
+
+        m.GetMerged(merged);
+
+        double tMerged = Millis(start);
+
+        std::cout << numPolys-1 << " holes: "
+            << "nesting pairwise " << tPip << "ms, tree " << tTree << "ms"
+            << (nesting == pairwise ? "" : " (DIFFERENT)")
+            << ", whole GetMerged " << tMerged << "ms" << std::endl;
+    }
+
+    return 0;
+}
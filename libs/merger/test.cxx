@@ -28,8 +28,6 @@ limitations under the License.
 #include "Tools.h"
 #include "Merger.h"
 
-int Point::_tag = 0;
-
 void ToPoly (const Json::Value& pts, PolyType &poly) {
     int i = 0;
 
@@ -0,0 +1,335 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include "Predicates.h"
+
+// expansionen sind nach aufsteigendem betrag sortiert, nullen werden entfernt
+
+namespace {
+
+const double eps = std::ldexp(1., -53);
+
+const double ccwErrBoundA = (3+16*eps)*eps;
+const double o3dErrBoundA = (7+56*eps)*eps;
+const double planeErrBoundA = (5+32*eps)*eps;
+
+inline void FastTwoSum (double a, double b, double &x, double &y) {
+    x = a+b;
+    y = b-(x-a);
+}
+
+inline void TwoSum (double a, double b, double &x, double &y) {
+    x = a+b;
+    double bv = x-a,
+        av = x-bv;
+    y = (a-av)+(b-bv);
+}
+
+inline void TwoDiff (double a, double b, double &x, double &y) {
+    x = a-b;
+    double bv = a-x,
+        av = x+bv;
+    y = (a-av)+(bv-b);
+}
+
+inline void TwoProduct (double a, double b, double &x, double &y) {
+    // fma ist exakt und wird nicht durch -ffp-contract verfälscht
+    x = a*b;
+    y = std::fma(a, b, -x);
+}
+
+int Diff (double a, double b, double *h) {
+    double x, y;
+    TwoDiff(a, b, x, y);
+
+    int n = 0;
+
+    if (y != 0) {
+        h[n++] = y;
+    }
+
+    h[n++] = x;
+
+    return n;
+}
+
+int Grow (int n, const double *e, double b, double *h) {
+    double q = b, s, hh;
+
+    int m = 0;
+
+    for (int i = 0; i < n; i++) {
+        TwoSum(q, e[i], s, hh);
+        q = s;
+
+        if (hh != 0) {
+            h[m++] = hh;
+        }
+    }
+
+    if (q != 0 || m == 0) {
+        h[m++] = q;
+    }
+
+    return m;
+}
+
+int Sum (int n, const double *e, int k, const double *f, double *h) {
+    double tmp[192];
+
+    std::copy_n(e, n, h);
+
+    for (int i = 0; i < k; i++) {
+        n = Grow(n, h, f[i], tmp);
+        std::copy_n(tmp, n, h);
+    }
+
+    return n;
+}
+
+int Scale (int n, const double *e, double b, double *h) {
+    double q, p1, p0, s, hh;
+
+    int m = 0;
+
+    TwoProduct(e[0], b, q, hh);
+
+    if (hh != 0) {
+        h[m++] = hh;
+    }
+
+    for (int i = 1; i < n; i++) {
+        TwoProduct(e[i], b, p1, p0);
+
+        TwoSum(q, p0, s, hh);
+        if (hh != 0) {
+            h[m++] = hh;
+        }
+
+        FastTwoSum(p1, s, q, hh);
+        if (hh != 0) {
+            h[m++] = hh;
+        }
+    }
+
+    if (q != 0 || m == 0) {
+        h[m++] = q;
+    }
+
+    return m;
+}
+
+int Mul (int n, const double *e, int k, const double *f, double *h) {
+    double s[64], t[192];
+
+    int m = 0;
+
+    for (int i = 0; i < k; i++) {
+        int l = Scale(n, e, f[i], s);
+
+        if (m == 0) {
+            std::copy_n(s, l, h);
+            m = l;
+        } else {
+            m = Sum(m, h, l, s, t);
+            std::copy_n(t, m, h);
+        }
+    }
+
+    return m;
+}
+
+// a*b-c*d
+int Det2 (int nA, const double *a, int nB, const double *b, int nC, const double *c, int nD, const double *d, double *h) {
+    double p[8], q[8];
+
+    int nP = Mul(nA, a, nB, b, p),
+        nQ = Mul(nC, c, nD, d, q);
+
+    for (int i = 0; i < nQ; i++) {
+        q[i] = -q[i];
+    }
+
+    return Sum(nP, p, nQ, q, h);
+}
+
+double Orient2dExact (const double *a, const double *b, const double *c) {
+    double acx[2], acy[2], bcx[2], bcy[2], det[16];
+
+    int nAcx = Diff(a[0], c[0], acx),
+        nAcy = Diff(a[1], c[1], acy),
+        nBcx = Diff(b[0], c[0], bcx),
+        nBcy = Diff(b[1], c[1], bcy);
+
+    int n = Det2(nAcx, acx, nBcy, bcy, nAcy, acy, nBcx, bcx, det);
+
+    return det[n-1];
+}
+
+double Orient3dExact (const double *a, const double *b, const double *c, const double *d) {
+    double ad[3][2], bd[3][2], cd[3][2];
+    int nAd[3], nBd[3], nCd[3];
+
+    for (int i = 0; i < 3; i++) {
+        nAd[i] = Diff(a[i], d[i], ad[i]);
+        nBd[i] = Diff(b[i], d[i], bd[i]);
+        nCd[i] = Diff(c[i], d[i], cd[i]);
+    }
+
+    double bc[16], ca[16], ab[16];
+
+    int nBc = Det2(nBd[0], bd[0], nCd[1], cd[1], nCd[0], cd[0], nBd[1], bd[1], bc),
+        nCa = Det2(nCd[0], cd[0], nAd[1], ad[1], nAd[0], ad[0], nCd[1], cd[1], ca),
+        nAb = Det2(nAd[0], ad[0], nBd[1], bd[1], nBd[0], bd[0], nAd[1], ad[1], ab);
+
+    double tA[64], tB[64], tC[64], s[128], det[192];
+
+    int nA = Mul(nBc, bc, nAd[2], ad[2], tA),
+        nB = Mul(nCa, ca, nBd[2], bd[2], tB),
+        nC = Mul(nAb, ab, nCd[2], cd[2], tC);
+
+    int nS = Sum(nA, tA, nB, tB, s),
+        n = Sum(nS, s, nC, tC, det);
+
+    return det[n-1];
+}
+
+double OrientPlaneExact (const double *n, const double *p, const double *q) {
+    double qp[2], t[4], det[12], tmp[12];
+
+    int m = 0;
+
+    for (int i = 0; i < 3; i++) {
+        int nQp = Diff(q[i], p[i], qp),
+            nT = Scale(nQp, qp, n[i], t);
+
+        if (m == 0) {
+            std::copy_n(t, nT, det);
+            m = nT;
+        } else {
+            m = Sum(m, det, nT, t, tmp);
+            std::copy_n(tmp, m, det);
+        }
+    }
+
+    return det[m-1];
+}
+
+}
+
+double Orient2d (const double *a, const double *b, const double *c) {
+    double detL = (a[0]-c[0])*(b[1]-c[1]),
+        detR = (a[1]-c[1])*(b[0]-c[0]),
+        det = detL-detR,
+        detSum;
+
+    if (detL > 0) {
+        if (detR <= 0) {
+            return det;
+        }
+        detSum = detL+detR;
+    } else if (detL < 0) {
+        if (detR >= 0) {
+            return det;
+        }
+        detSum = -detL-detR;
+    } else {
+        return det;
+    }
+
+    double errBound = ccwErrBoundA*detSum;
+
+    if (det >= errBound || -det >= errBound) {
+        return det;
+    }
+
+    return Orient2dExact(a, b, c);
+}
+
+double Orient3d (const double *a, const double *b, const double *c, const double *d) {
+    double adx = a[0]-d[0],
+        ady = a[1]-d[1],
+        adz = a[2]-d[2],
+        bdx = b[0]-d[0],
+        bdy = b[1]-d[1],
+        bdz = b[2]-d[2],
+        cdx = c[0]-d[0],
+        cdy = c[1]-d[1],
+        cdz = c[2]-d[2];
+
+    double bdxcdy = bdx*cdy,
+        cdxbdy = cdx*bdy,
+        cdxady = cdx*ady,
+        adxcdy = adx*cdy,
+        adxbdy = adx*bdy,
+        bdxady = bdx*ady;
+
+    double det = adz*(bdxcdy-cdxbdy)
+        +bdz*(cdxady-adxcdy)
+        +cdz*(adxbdy-bdxady);
+
+    double perm = (std::abs(bdxcdy)+std::abs(cdxbdy))*std::abs(adz)
+        +(std::abs(cdxady)+std::abs(adxcdy))*std::abs(bdz)
+        +(std::abs(adxbdy)+std::abs(bdxady))*std::abs(cdz);
+
+    double errBound = o3dErrBoundA*perm;
+
+    if (det > errBound || -det > errBound) {
+        return det;
+    }
+
+    return Orient3dExact(a, b, c, d);
+}
+
+double OrientPlane (const double *n, const double *p, const double *q) {
+    double x = n[0]*(q[0]-p[0]),
+        y = n[1]*(q[1]-p[1]),
+        z = n[2]*(q[2]-p[2]);
+
+    double det = x+y+z,
+        perm = std::abs(x)+std::abs(y)+std::abs(z);
+
+    double errBound = planeErrBoundA*perm;
+
+    if (det > errBound || -det > errBound) {
+        return det;
+    }
+
+    return OrientPlaneExact(n, p, q);
+}
+
+double Orient2dFast (const double *a, const double *b, const double *c) {
+    return (a[0]-c[0])*(b[1]-c[1])-(a[1]-c[1])*(b[0]-c[0]);
+}
+
+double Orient3dFast (const double *a, const double *b, const double *c, const double *d) {
+    double adx = a[0]-d[0],
+        ady = a[1]-d[1],
+        adz = a[2]-d[2],
+        bdx = b[0]-d[0],
+        bdy = b[1]-d[1],
+        bdz = b[2]-d[2],
+        cdx = c[0]-d[0],
+        cdy = c[1]-d[1],
+        cdz = c[2]-d[2];
+
+    return adz*(bdx*cdy-cdx*bdy)
+        +bdz*(cdx*ady-adx*cdy)
+        +cdz*(adx*bdy-bdx*ady);
+}
@@ -0,0 +1,43 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __Predicates_h
+#define __Predicates_h
+
+// adaptive orientierungstests nach shewchuk
+// (https://www.cs.cmu.edu/~quake/robust.html)
+
+// das vorzeichen ist immer exakt, der betrag nur eine näherung
+
+// > 0, wenn a, b, c gegen den uhrzeigersinn liegen
+double Orient2d (const double *a, const double *b, const double *c);
+
+// > 0, wenn d unterhalb der ebene durch a, b, c liegt (a, b, c von oben gesehen gegen den uhrzeigersinn)
+double Orient3d (const double *a, const double *b, const double *c, const double *d);
+
+// > 0, wenn q oberhalb der ebene durch p mit der normalen n liegt, also dot(n, q-p)
+// n wird als exakt angenommen, so gilt das vorzeichen für genau die ebene, mit der auch sonst gerechnet wird
+double OrientPlane (const double *n, const double *p, const double *q);
+
+// ohne filter und ohne exakte auswertung, nur zum vergleichen
+double Orient2dFast (const double *a, const double *b, const double *c);
+double Orient3dFast (const double *a, const double *b, const double *c, const double *d);
+
+inline int Sign (double v) {
+    return (v > 0) - (v < 0);
+}
+
+#endif
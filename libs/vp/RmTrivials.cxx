@@ -60,7 +60,7 @@ void TrivialRm::RemovePockets (VertsType3 &good, double *rot, double d, Src src)
         std::vector<int> _s;
 
         for (itr = pocket.begin()+1; itr != pocket.end()-1; ++itr) {
-            double e = (verts[*itr].x*rot[0]+verts[*itr].y*rot[1])-d;
+            double e = (verts[*itr].pt[0]*rot[0]+verts[*itr].pt[1]*rot[1])-d;
 
             if (std::abs(e) > E) {
                 _s.push_back(int(e/std::abs(e)));
@@ -441,8 +441,8 @@ void TrivialRm::GetSimplified (PolyType &res) {
     int iA = (ind2+1)%numPts,
         iB = (ind2+numPts-1)%numPts;
 
-    double rA[] = {poly[iA].x-poly[ind2].x, poly[iA].y-poly[ind2].y},
-        rB[] = {poly[iB].x-poly[ind2].x, poly[iB].y-poly[ind2].y};
+    double rA[] = {poly[iA].pt[0]-poly[ind2].pt[0], poly[iA].pt[1]-poly[ind2].pt[1]},
+        rB[] = {poly[iB].pt[0]-poly[ind2].pt[0], poly[iB].pt[1]-poly[ind2].pt[1]};
 
     int num = numPts;
 
@@ -478,7 +478,7 @@ void TrivialRm::GetSimplified (PolyType &res) {
             if (d && d->t1 > E) {
                 // std::cout << *d << std::endl;
 
-                Vert3 _v(d->s, Src::A, d->t1);
+                Vert3 _v(d->s, tr.NewTag(), Src::A, d->t1);
                 newVerts.emplace(d->t2, _v);
                 num++;
 
@@ -502,7 +502,7 @@ void TrivialRm::GetSimplified (PolyType &res) {
             if (d && d->t1 > E) {
                 // std::cout << *d << std::endl;
 
-                Vert3 _v(d->s, Src::B, d->t1);
+                Vert3 _v(d->s, tr.NewTag(), Src::B, d->t1);
                 newVerts.emplace(d->t2, _v);
                 num++;
 
@@ -522,11 +522,11 @@ void TrivialRm::GetSimplified (PolyType &res) {
 
     for (itr2 = verts.begin(); itr2 != verts.end(); ++itr2) {
         if (itr2->src != Src::NONE
-            && tr.locs.at(itr2->tag).t < E) {
+            && tr.Get(itr2->tag).t < E) {
             itr3 = itr2 != verts.begin() ? itr2-1 : verts.end()-1;
 
             if (itr3->id == NO_USE
-                && itr2->tag == tr.locs.at(itr3->tag).edA) {
+                && itr2->tag == tr.Get(itr3->tag).edA) {
 
                 itr3->rm = true;
             }
@@ -35,7 +35,7 @@ public:
     // i wird in GetSimplified explizit gesetzt
 
     Vert3 (Point &p) : Point(p), rm(false), src(Src::NONE), t(0), i(NO_USE) {}
-    Vert3 (double *_s, Src _src, double _t) : Point(_s), rm(false), src(_src), t(_t), i(NO_USE) {}
+    Vert3 (double *_s, int _tag, Src _src, double _t) : Point(_s[0], _s[1], NO_USE, _tag), rm(false), src(_src), t(_t), i(NO_USE) {}
 
     bool rm;
     Src src;
@@ -45,7 +45,7 @@ public:
 
     friend std::ostream& operator<< (std::ostream &out, const Vert3 &v) {
         out << "id: " << v.id
-            << ", pt: [" << v.x << "," << v.y << "]"
+            << ", pt: [" << v.pt[0] << "," << v.pt[1] << "]"
             << ", t: " << v.t
             << ", src: " << static_cast<int>(v.src)
             << ", rm: " << v.rm
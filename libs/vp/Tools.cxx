@@ -19,6 +19,7 @@ limitations under the License.
 #include <cfloat>
 
 #include "Tools.h"
+#include "Predicates.h"
 
 double Normalize (double *v, const int n) {
     double l;
@@ -62,10 +63,14 @@ bool Ld (double *a, double *b, double *c, double *r) {
 
 double Cross (double *a, double *b, double *c) {
     // kreuzprodukt der vektoren ab und ac
+#ifdef EXACT_PREDICATES
+    return -Orient2d(a, b, c);
+#else
     return (b[1]-a[1])*(c[0]-a[0])-(b[0]-a[0])*(c[1]-a[1]);
+#endif
 }
 
-std::shared_ptr<D> Intersect (const double *o, const double *r, const double *pA, const double *pB) {
+bool Intersect (const double *o, const double *r, const double *pA, const double *pB, D &d) {
     double oB[] = {o[0]+r[0], o[1]+r[1]};
 
     double m11 = oB[0]-o[0],
@@ -78,21 +83,32 @@ std::shared_ptr<D> Intersect (const double *o, const double *r, const double *pA
     double det = m11*m22-m12*m21;
 
     if (std::abs(det) < E) {
-        return nullptr;
+        return false;
     }
 
     double t1 = (v1*m22-m12*v2)/det,
         t2 = (m11*v2-v1*m21)/det;
 
     if (t2 > -E && t2 < 1-E) {
-        double s[] = {pA[0]+t2*(pB[0]-pA[0]), pA[1]+t2*(pB[1]-pA[1])};
-        return std::make_shared<D>(s, t1, t2);
+        d.s[0] = pA[0]+t2*(pB[0]-pA[0]);
+        d.s[1] = pA[1]+t2*(pB[1]-pA[1]);
+        d.t1 = t1;
+        d.t2 = t2;
+        return true;
     } else {
-        return nullptr;
+        return false;
     }
 }
 
-std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double *pA, const double *pB, const Bnds &bnds) {
+std::shared_ptr<D> Intersect (const double *o, const double *r, const double *pA, const double *pB) {
+    D d;
+    if (Intersect(o, r, pA, pB, d)) {
+        return std::make_shared<D>(d);
+    }
+    return nullptr;
+}
+
+bool Intersect2 (const double *oA, const double *oB, const double *pA, const double *pB, const Bnds &bnds, D &d) {
     double m11 = oB[0]-oA[0],
         m12 = pA[0]-pB[0],
         m21 = oB[1]-oA[1],
@@ -103,7 +119,7 @@ std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double
     double det = m11*m22-m12*m21;
 
     if (std::abs(det) < E) {
-        return nullptr;
+        return false;
     }
 
     double t1 = (v1*m22-m12*v2)/det,
@@ -115,13 +131,24 @@ std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double
     if (t1 > bnds.lA && t1 < bnds.uA
         && t2 > bnds.lB && t2 < bnds.uB) {
 
-        double s[] = {pA[0]+t2*(pB[0]-pA[0]), pA[1]+t2*(pB[1]-pA[1])};
-        return std::make_shared<D>(s, t1, t2);
+        d.s[0] = pA[0]+t2*(pB[0]-pA[0]);
+        d.s[1] = pA[1]+t2*(pB[1]-pA[1]);
+        d.t1 = t1;
+        d.t2 = t2;
+        return true;
     } else {
-        return nullptr;
+        return false;
     }
 }
 
+std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double *pA, const double *pB, const Bnds &bnds) {
+    D d;
+    if (Intersect2(oA, oB, pA, pB, bnds, d)) {
+        return std::make_shared<D>(d);
+    }
+    return nullptr;
+}
+
 std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double *pA, const double *pB) {
     const Bnds bnds;
     return Intersect2(oA, oB, pA, pB, bnds);
@@ -165,7 +192,7 @@ bool TestCW (const PolyType &poly) {
     for (int i = 0; i < num; i++) {
         const Point &a = poly[i],
             &b = poly[(i+1)%num];
-        sum += a.x*b.y-b.x*a.y;
+        sum += a.pt[0]*b.pt[1]-b.pt[0]*a.pt[1];
     }
 
     return sum < 0;
@@ -175,7 +202,7 @@ std::string GetAbsolutePath (const PolyType &poly) {
     std::stringstream path;
 
     for (const Point& p : poly) {
-        path << p.x << "," << p.y << " ";
+        path << p.pt[0] << "," << p.pt[1] << " ";
     }
 
     std::string svg = "M" + path.str() + "Z";
@@ -200,14 +227,23 @@ bool TestPip (PolyType &poly, Point &pt) {
         Point &a = poly[i],
             &b = poly[(i+1)%num];
 
-        if ((a.x <= pt.x || b.x <= pt.x)
-            && ((a.y < pt.y && b.y >= pt.y)
-                || (b.y < pt.y && a.y >= pt.y))) {
+        if ((a.pt[0] <= pt.pt[0] || b.pt[0] <= pt.pt[0])
+            && ((a.pt[1] < pt.pt[1] && b.pt[1] >= pt.pt[1])
+                || (b.pt[1] < pt.pt[1] && a.pt[1] >= pt.pt[1]))) {
 
+#ifdef EXACT_PREDICATES
+            // liegt pt rechts von der kante?
+            double o = Orient2d(a.pt, b.pt, pt.pt);
+
+            if (b.pt[1] > a.pt[1] ? o < 0 : o > 0) {
+                in = !in;
+            }
+#else
             // schnittpunkt mit bounding box und strahlensatz
-            if (a.x+(pt.y-a.y)*(b.x-a.x)/(b.y-a.y) < pt.x) {
+            if (a.pt[0]+(pt.pt[1]-a.pt[1])*(b.pt[0]-a.pt[0])/(b.pt[1]-a.pt[1]) < pt.pt[0]) {
                 in = !in;
             }
+#endif
         }
     }
 
@@ -216,28 +252,28 @@ bool TestPip (PolyType &poly, Point &pt) {
 
 void GetExt (const PolyType &poly, Ext &ext) {
     for (auto &p : poly) {
-        if (p.x < ext.minX) {
-            ext.minX = p.x;
+        if (p.pt[0] < ext.minX) {
+            ext.minX = p.pt[0];
         }
-        if (p.x > ext.maxX) {
-            ext.maxX = p.x;
+        if (p.pt[0] > ext.maxX) {
+            ext.maxX = p.pt[0];
         }
-        if (p.y < ext.minY) {
-            ext.minY = p.y;
+        if (p.pt[1] < ext.minY) {
+            ext.minY = p.pt[1];
         }
-        if (p.y > ext.maxY) {
-            ext.maxY = p.y;
+        if (p.pt[1] > ext.maxY) {
+            ext.maxY = p.pt[1];
         }
     }
 }
 
 double GetDis (const Point &pA, const Point &pB, const Point &pC, double &t, double *pro) {
     // pC muss zw. pA, pB liegen
-    double n[] = {pA.y-pB.y, pB.x-pA.x},
+    double n[] = {pA.pt[1]-pB.pt[1], pB.pt[0]-pA.pt[0]},
         l = Normalize(n),
-        d = n[0]*(pA.x-pC.x)+n[1]*(pA.y-pC.y),
-        v[] = {pC.x+d*n[0], pC.y+d*n[1]},
-        w[] = {v[0]-pA.x, v[1]-pA.y},
+        d = n[0]*(pA.pt[0]-pC.pt[0])+n[1]*(pA.pt[1]-pC.pt[1]),
+        v[] = {pC.pt[0]+d*n[0], pC.pt[1]+d*n[1]},
+        w[] = {v[0]-pA.pt[0], v[1]-pA.pt[1]},
         m = Normalize(w);
 
     t = (n[1]*w[0]-n[0]*w[1])*m/l;
@@ -251,8 +287,8 @@ double GetDis (const Point &pA, const Point &pB, const Point &pC, double &t, dou
 
 double GetDis2 (const Point &a, const Point &b) {
     double v[] = {
-        b.x-a.x,
-        b.y-a.y
+        b.pt[0]-a.pt[0],
+        b.pt[1]-a.pt[1]
     };
     return v[0]*v[0]+v[1]*v[1];
 }
@@ -266,7 +302,3 @@ void GetSect (int tagA, int tagB, PolyType &poly) {
         return p.tag == tagB;
     })+1, poly.end());
 }
-
-#ifdef _WIN32
-int Point::_tag;
-#endif
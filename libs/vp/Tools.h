@@ -27,6 +27,7 @@ limitations under the License.
 #include <algorithm>
 #include <cfloat>
 #include <exception>
+#include <type_traits>
 
 #define NO_USE -1
 #define PI std::acos(-1)
@@ -56,51 +57,39 @@ public:
 
 typedef std::vector<int> IdsType;
 
+// der tag wird von der jeweiligen operation vergeben (siehe Tracker::NewTag)
+
 class Point {
-    static int _tag;
 public:
-    Point (double _x, double _y, int _id = NO_USE) : id(_id), tag(_tag++) {
+    Point (double _x, double _y, int _id = NO_USE, int _tag = NO_USE) : id(_id), tag(_tag) {
         pt[0] = _x;
         pt[1] = _y;
     }
     Point (double *_pt, int _id = NO_USE) : Point(_pt[0], _pt[1], _id) {}
 
-    Point (const Point& p) : id(p.id), tag(p.tag) {
-        pt[0] = p.pt[0];
-        pt[1] = p.pt[1];
-    }
-
-    Point& operator= (const Point &p) {
-        pt[0] = p.pt[0];
-        pt[1] = p.pt[1];
-        id = p.id;
-        tag = p.tag;
-
-        return *this;
-    }
+    // reiner werttyp, kopieren ist ein memcpy
 
     double pt[2];
-
-    const double &x = pt[0],
-        &y = pt[1];
     int id, tag;
 
     friend std::ostream& operator<< (std::ostream &out, const Point &p) {
-        out << "id: " << p.id << ", pt: [" << p.x << "," << p.y << "], tag: " << p.tag;
+        out << "id: " << p.id << ", pt: [" << p.pt[0] << "," << p.pt[1] << "], tag: " << p.tag;
         return out;
     }
 
     bool operator< (const Point &other) const {
-        const int x1 = static_cast<int>(x*1e5),
-            y1 = static_cast<int>(y*1e5),
-            x2 = static_cast<int>(other.x*1e5),
-            y2 = static_cast<int>(other.y*1e5);
+        const int x1 = static_cast<int>(pt[0]*1e5),
+            y1 = static_cast<int>(pt[1]*1e5),
+            x2 = static_cast<int>(other.pt[0]*1e5),
+            y2 = static_cast<int>(other.pt[1]*1e5);
 
         return std::tie(x1, y1) < std::tie(x2, y2);
     }
 
 };
 
+static_assert(std::is_trivially_copyable<Point>::value, "Point must be trivially copyable");
+
 typedef std::vector<Point> PolyType;
 
 double Normalize (double *v, const int n = 2);
@@ -110,6 +99,7 @@ double Cross (double *a, double *b, double *c);
 
 class D {
 public:
+    D () {}
     D (double *_s) {
         s[0] = _s[0];
         s[1] = _s[1];
@@ -139,6 +129,10 @@ std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double
 
 std::shared_ptr<D> Intersect2 (const double *oA, const double *oB, const double *pA, const double *pB);
 
+// ohne allokation, d wird nur bei einem schnitt gesetzt
+bool Intersect (const double *o, const double *r, const double *pA, const double *pB, D &d);
+bool Intersect2 (const double *oA, const double *oB, const double *pA, const double *pB, const Bnds &bnds, D &d);
+
 bool IsFrontfaced (double *r, double *a, double *b);
 bool IsNear (const double *a, const double *b);
 double GetT (double *a, double *b, double *c);
@@ -180,9 +174,9 @@ double GetDis2 (const Point &a, const Point &b);
 
 void GetSect (int tagA, int tagB, PolyType &poly);
 
-inline void vtkbool_throw (bool test, const std::string &where, const std::string &msg) {
+inline void vtkbool_throw (bool test, const char *where, const char *msg) {
     if (!test) {
-        throw std::runtime_error("Exception (" + where + ", " + msg + ")");
+        throw std::runtime_error(std::string("Exception (") + where + ", " + msg + ")");
     }
 }
 
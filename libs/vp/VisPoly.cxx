@@ -28,428 +28,454 @@ limitations under the License.
 #include "RmTrivials.h"
 #include "AABB.h"
 
-void GetVisPoly (PolyType &poly, Tracker &tr, PolyType &res, int ind) {
+void GetVisPoly (PolyType &poly, Tracker &tr, PolyType &res, VisPolyWs &ws, int ind) {
     if (poly.size() < 3) {
         return;
     }
 
     // std::cout << "?_ --" << std::endl;
 
-    double x[] = {poly[ind].x, poly[ind].y};
+    double x[] = {poly[ind].pt[0], poly[ind].pt[1]};
 
-    VertsType verts;
+    ws.Clear();
+
+    VertsType &verts = ws.verts;
 
     int num = poly.size();
 
+    verts.reserve(2*num);
+    ws.repl.reserve(2*num);
+
     for (int i = 0; i < num-1; i++) {
         int _i = (ind+i+1)%num;
-        verts.push_back(Vert(x, poly[_i])); // xxx
+        ws.AddVert(Vert(x, poly[_i], i < num-2 ? i+1 : NO_USE)); // xxx
     }
 
-    double ref[] = {verts[0].pt[0]-x[0], verts[0].pt[1]-x[1]};
-    Normalize(ref);
-
-    for (Vert& v : verts) {
-        v.phi = GetAngle(ref, v.r);
+    double *ref = ws.ref;
 
-        // std::cout << v.phi*180/PI << std::endl;
-    }
+    ref[0] = verts[0].pt[0]-x[0];
+    ref[1] = verts[0].pt[1]-x[1];
 
-    for (int i = 0; i < num-2; i++) {
-        verts[i].nxt = i+1;
-    }
+    Normalize(ref);
 
     /*for (Vert& v : verts) {
         std::cout << v.tag << " -> " << verts[v.nxt].tag << std::endl;
     }*/
 
-    IdsType vp = {0, 1};
+    IdsType &vp = ws.vp;
+
+    vp.push_back(0);
+    vp.push_back(1);
 
     int t = 0, u, v;
 
-    std::vector<Bag> leftBags;
+    std::vector<Bag> &leftBags = ws.leftBags;
 
-    std::map<int, int> repl;
+    IdsType &repl = ws.repl;
 
-    try {
-        for (int _i = 0;; _i++) {
-            u = verts.at(t).nxt;
-            v = verts.at(u).nxt;
+    // auf verts wird nur über indexe zugegriffen, ein NO_USE führt zum abbruch
 
-            if (v == NO_USE) {
-                break;
-            }
+    const char *noElem = "cannot access element in verts";
 
-            // std::cout << "?_ > " << (u+1) << ", " << (v+1) << std::endl;
+    // jeder durchlauf rückt entlang von nxt vor, ein zyklus würde sonst endlos laufen
+    const int maxIts = 10*num;
 
-            double ptU[2], ptV[2];
+    for (int _i = 0;; _i++) {
+        vtkbool_throw(_i < maxIts, "GetVisPoly", "no progress");
 
-            Cpy(ptU, verts.at(u).pt);
-            Cpy(ptV, verts.at(v).pt);
+        u = verts[t].nxt;
 
-            if (Ld(x, ptU, ptV)) {
-                // std::cout << "?_ skipping" << std::endl;
+        vtkbool_throw(u != NO_USE, "GetVisPoly", noElem);
 
-                double lU = GetDis2(x, verts.at(u)),
-                    lV = GetDis2(x, verts.at(v));
+        v = verts[u].nxt;
 
-                if (lU > lV) {
-                    verts.at(u).id = NO_USE;
-                } else {
-                    verts.at(v).id = NO_USE;
+        if (v == NO_USE) {
+            break;
+        }
 
-                    repl.emplace(v, u);
-                }
+        // std::cout << "?_ > " << (u+1) << ", " << (v+1) << std::endl;
 
-                t = u;
-                continue;
-            }
+        double ptU[2], ptV[2];
 
-            double cA = Cross(x, ptU, ptV),
-                cB = Cross(verts.at(t).pt, ptU, ptV);
+        Cpy(ptU, verts[u].pt);
+        Cpy(ptV, verts[v].pt);
 
-            /*std::cout << "?_ cA " << cA << std::endl;
-            std::cout << "?_ cB " << cB << std::endl;*/
+        if (Ld(x, ptU, ptV)) {
+            // std::cout << "?_ skipping" << std::endl;
 
-            if (cA < 0) {
-                // std::cout << "?_ vis" << std::endl;
+            double lU = GetDis2(x, verts[u]),
+                lV = GetDis2(x, verts[v]);
 
-                if (vp.back() != u) {
-                    vp.push_back(u);
+            if (lU > lV) {
+                verts[u].id = NO_USE;
+            } else {
+                verts[v].id = NO_USE;
+
+                if (repl[v] == NO_USE) {
+                    repl[v] = u;
                 }
+            }
 
-                vp.push_back(v);
+            t = u;
+            continue;
+        }
 
-                t = u;
-            } else {
-                if (cB > 0 || IsNear(verts.at(t).pt, ptV)) {
+        double cA = Cross(x, ptU, ptV),
+            cB = Cross(verts[t].pt, ptU, ptV);
 
-                    int w = v;
-                    for (;;) {
-                        Vert &a = verts.at(w),
-                            &b = verts.at(a.nxt);
+        /*std::cout << "?_ cA " << cA << std::endl;
+        std::cout << "?_ cB " << cB << std::endl;*/
 
-                        double *ptA = a.pt,
-                            *ptB = b.pt;
+        if (cA < 0) {
+            // std::cout << "?_ vis" << std::endl;
 
-                        // std::cout << "?_ 1> " << (w+1) << ", " << (a.nxt+1) << std::endl;
+            if (vp.back() != u) {
+                vp.push_back(u);
+            }
 
-                        std::shared_ptr<D> d(Intersect(x, verts.at(u).r, ptA, ptB));
+            vp.push_back(v);
 
-                        if (d
-                            && d->t1 > E
-                            && IsFrontfaced(verts.at(u).r, ptA, ptB)) {
+            t = u;
+        } else {
+            if (cB > 0 || IsNear(verts[t].pt, ptV)) {
 
-                            // steht im zusammenhang mit dem skipping
+                int w = v;
+                for (;;) {
+                    int nxt = verts[w].nxt;
 
-                            int _u = u;
+                    // tritt meistens dann ein, wenn det() zum nullptr führt oder d->s zu nahe an x ist
+                    vtkbool_throw(nxt != NO_USE, "GetVisPoly", noElem);
 
-                            for (;;) {
-                                try {
-                                    _u = repl.at(_u);
-                                } catch (...) {
-                                    break;
-                                }
-                            }
+                    // kopien, verts kann sich unten ändern
+                    Point a = verts[w],
+                        b = verts[nxt];
 
-                            if (d->t2 < E) {
-                                verts.at(_u).nxt = w;
-                                vp.push_back(w);
-                                t = _u;
-                                leftBags.push_back(Bag(_u, w, verts.at(_u).phi));
+                    double *ptA = a.pt,
+                        *ptB = b.pt;
 
-                                verts.at(w).id = NO_USE;
+                    // std::cout << "?_ 1> " << (w+1) << ", " << (nxt+1) << std::endl;
 
-                            } else {
+                    D d;
 
-                                Point _p(d->s);
+                    if (Intersect(x, verts[u].r, ptA, ptB, d)
+                        && d.t1 > E
+                        && IsFrontfaced(verts[u].r, ptA, ptB)) {
 
-                                Vert _v(x, _p, ref, a.nxt);
-                                verts.push_back(_v); // xxx
+                        // steht im zusammenhang mit dem skipping
 
-                                int k = verts.size()-1;
+                        int _u = u;
 
-                                verts.at(_u).nxt = k;
+                        while (repl[_u] != NO_USE) {
+                            _u = repl[_u];
+                        }
 
-                                vp.push_back(k);
+                        if (d.t2 < E) {
+                            verts[_u].nxt = w;
+                            vp.push_back(w);
+                            t = _u;
+                            leftBags.emplace_back(_u, w);
 
-                                t = _u;
+                            verts[w].id = NO_USE;
 
-                                leftBags.push_back(Bag(_u, k, verts.at(_u).phi));
+                        } else {
 
-                                tr.Track(a, b, _v, d->t2);
+                            Point _p(d.s[0], d.s[1], NO_USE, tr.NewTag());
 
-                            }
+                            Vert _v(x, _p, nxt);
 
-                            break;
+                            tr.Track(a, b, _v, d.t2);
+
+                            int k = ws.AddVert(_v); // xxx
+
+                            verts[_u].nxt = k;
+
+                            vp.push_back(k);
+
+                            t = _u;
+
+                            leftBags.emplace_back(_u, k);
 
-                        } else {
-                            w = a.nxt;
                         }
 
-                        // tritt meistens dann ein, wenn det() zum nullptr führt oder d->s zu nahe an x ist
-                        vtkbool_throw(w != NO_USE, "GetVisPoly", "w not set");
+                        break;
 
+                    } else {
+                        w = nxt;
                     }
 
-                } else if (cB < 0) {
-                    // schnitt mit leftBags?
+                }
 
-                    std::shared_ptr<Bag> bag;
-                    std::shared_ptr<D> d;
+            } else if (cB < 0) {
+                // schnitt mit leftBags?
 
-                    while (leftBags.size() > 0 && !d) {
-                        bag = std::make_shared<Bag>(leftBags.back());
+                int f = NO_USE;
 
-                        if (bag->phi > verts.at(v).phi || std::abs(bag->phi-verts.at(v).phi) < E) {
-                            d = Intersect2(verts.at(bag->f).pt, verts.at(bag->g).pt, ptU, ptV);
+                D d;
 
-                            leftBags.pop_back();
-                        } else {
+                while (leftBags.size() > 0) {
+                    const Bag &bag = leftBags.back();
+
+                    if (ws.IsNotBefore(bag.f, v)) {
+                        f = bag.f;
+
+                        bool found = Intersect2(verts[bag.f].pt, verts[bag.g].pt, ptU, ptV, Bnds(), d);
+
+                        leftBags.pop_back();
+
+                        if (found) {
                             break;
                         }
+
+                        f = NO_USE;
+                    } else {
+                        break;
                     }
+                }
 
-                    if (d) {
-                        // std::cout << "?_ bag " << *bag << std::endl;
+                if (f != NO_USE) {
+                    // std::cout << "?_ bag " << f << std::endl;
 
-                        assert(std::find(vp.begin(), vp.end(), bag->f) != vp.end());
+                    assert(std::find(vp.begin(), vp.end(), f) != vp.end());
 
-                        while (vp.size() > 0 && vp.back() != bag->f) {
-                            // std::cout << "?_ popping_1 " << (vp.back()+1) << std::endl;
-                            vp.pop_back();
-                        }
+                    while (vp.size() > 0 && vp.back() != f) {
+                        // std::cout << "?_ popping_1 " << (vp.back()+1) << std::endl;
+                        vp.pop_back();
+                    }
 
-                        vtkbool_throw(vp.size() > 1, "GetVisPoly", "too many pop's");
+                    vtkbool_throw(vp.size() > 1, "GetVisPoly", "too many pop's");
 
-                        int _x = v;
+                    int _x = v;
 
-                        int i = 0;
+                    int i = 0;
 
-                        for (;;) {
-                            Vert &a = verts.at(_x),
-                                &b = verts.at(a.nxt);
+                    double ptF[2];
+                    Cpy(ptF, verts[f].pt);
 
-                            double *ptA = a.pt,
-                                *ptB = b.pt;
+                    for (;;) {
+                        int nxt = verts[_x].nxt;
 
-                            // std::cout << "?_ 2>" << (_x+1) << ", " << (a.nxt+1) << std::endl;
+                        vtkbool_throw(nxt != NO_USE, "GetVisPoly", noElem);
 
-                            std::shared_ptr<D> _d;
+                        Point a = verts[_x],
+                            b = verts[nxt];
 
-                            if (IsNear(verts.at(bag->f).pt, ptV)) {
-                                _d = std::make_shared<D>(verts.at(bag->f).pt);
-                            } else {
-                                _d = Intersect2(verts.at(bag->f).pt, d->s, ptB, ptA);
-                            }
+                        double *ptA = a.pt,
+                            *ptB = b.pt;
 
-                            if (_d
-                                && IsFrontfaced(verts.at(bag->f).r, ptA, ptB)
-                                && (i > 0 || Cross(ptA, ptU, ptB) < 0)) {
+                        // std::cout << "?_ 2>" << (_x+1) << ", " << (nxt+1) << std::endl;
 
-                                if (IsNear(verts.at(bag->f).pt, _d->s)) {
-                                    verts.at(bag->f).nxt = a.nxt;
+                        D _d;
 
-                                    vp.push_back(a.nxt);
+                        bool found;
 
-                                } else {
-                                    if (_d->t2 > 1-E) {
-                                        verts.at(bag->f).nxt = _x;
+                        if (IsNear(ptF, ptV)) {
+                            _d = D(ptF);
+                            found = true;
+                        } else {
+                            found = Intersect2(ptF, d.s, ptB, ptA, Bnds(), _d);
+                        }
 
-                                        vp.push_back(_x);
+                        if (found
+                            && IsFrontfaced(verts[f].r, ptA, ptB)
+                            && (i > 0 || Cross(ptA, ptU, ptB) < 0)) {
 
-                                        leftBags.push_back(Bag(bag->f, _x, bag->phi));
+                            if (IsNear(ptF, _d.s)) {
+                                verts[f].nxt = nxt;
 
-                                        verts.at(_x).id = NO_USE;
+                                vp.push_back(nxt);
 
-                                    } else {
+                            } else {
+                                if (_d.t2 > 1-E) {
+                                    verts[f].nxt = _x;
 
-                                        Point _p(_d->s);
+                                    vp.push_back(_x);
 
-                                        Vert _v(x, _p, ref, a.nxt);
-                                        verts.push_back(_v);
+                                    leftBags.emplace_back(f, _x);
 
-                                        int k = verts.size()-1;
+                                    verts[_x].id = NO_USE;
 
-                                        verts.at(bag->f).nxt = k;
+                                } else {
 
-                                        vp.push_back(k);
+                                    Point _p(_d.s[0], _d.s[1], NO_USE, tr.NewTag());
 
-                                        leftBags.push_back(Bag(bag->f, k, bag->phi));
+                                    Vert _v(x, _p, nxt);
 
-                                        tr.Track(b, a, _v, _d->t2);
+                                    tr.Track(b, a, _v, _d.t2);
 
-                                    }
+                                    int k = ws.AddVert(_v);
 
-                                }
+                                    verts[f].nxt = k;
 
-                                t = bag->f;
+                                    vp.push_back(k);
 
-                                break;
+                                    leftBags.emplace_back(f, k);
 
-                            } else {
-                                _x = a.nxt;
-                            }
+                                }
 
-                            vtkbool_throw(_x != NO_USE, "GetVisPoly", "_x not set");
+                            }
 
-                            i++;
+                            t = f;
 
+                            break;
 
+                        } else {
+                            _x = nxt;
                         }
 
-                    } else {
-                        while (vp.size() > 0) {
-                            int a = vp.end()[-2],
-                                b = vp.back();
+                        i++;
 
-                            // std::cout << "?_ popping_2 " << (vp.back()+1) << std::endl;
+                    }
 
-                            vp.pop_back();
+                } else {
+                    while (vp.size() > 0) {
+                        vtkbool_throw(vp.size() > 1, "GetVisPoly", "too many pop's");
 
-                            vtkbool_throw(vp.size() > 0, "GetVisPoly", "too many pop's");
+                        int a = vp.end()[-2],
+                            b = vp.back();
 
-                            std::shared_ptr<D> d(Intersect(x, verts.at(v).r, verts.at(a).pt, verts.at(b).pt));
+                        // std::cout << "?_ popping_2 " << (vp.back()+1) << std::endl;
 
-                            if (d) {
-                                if (d->t2 < E) {
-                                    int c = vp.end()[-2];
+                        vp.pop_back();
 
-                                    if (Ld(x, verts.at(a).pt, verts.at(c).pt) || IsNear(verts.at(a).pt, ptV)) {
-                                        vp.pop_back();
-                                        t = vp.back();
-                                    } else {
-                                        t = a;
-                                    }
+                        D d;
 
-                                } else {
-                                    Point _p(d->s);
+                        if (Intersect(x, verts[v].r, verts[a].pt, verts[b].pt, d)) {
+                            if (d.t2 < E) {
+                                // a kann auch der letzte in vp sein, dann gibt es kein c
 
-                                    Vert _v(x, _p, ref);
-                                    verts.push_back(_v);
+                                if (vp.size() > 1
+                                    && (Ld(x, verts[a].pt, verts[vp.end()[-2]].pt) || IsNear(verts[a].pt, ptV))) {
+                                    vp.pop_back();
+                                    t = vp.back();
+                                } else {
+                                    t = a;
+                                }
 
-                                    int k = verts.size()-1;
+                            } else {
+                                Point _p(d.s[0], d.s[1], NO_USE, tr.NewTag());
 
-                                    verts.at(a).nxt = k;
+                                Vert _v(x, _p);
 
-                                    vp.push_back(k);
+                                tr.Track(verts[a], verts[b], _v, d.t2);
 
-                                    t = k;
+                                int k = ws.AddVert(_v);
 
-                                    tr.Track(verts.at(a), verts.at(b), _v, d->t2);
+                                verts[a].nxt = k;
 
-                                }
+                                vp.push_back(k);
 
-                                break;
+                                t = k;
 
                             }
 
+                            break;
+
                         }
 
-                        int p = v;
+                    }
 
-                        int w = verts.at(v).nxt;
+                    int p = v;
 
-                        if (w == NO_USE) {
-                            break;
-                        }
+                    int w = verts[v].nxt;
 
-                        if (Ld(x, ptV, verts.at(w).pt)) {
-                            p = w;
-                            w = verts.at(w).nxt;
-                        }
+                    if (w == NO_USE) {
+                        break;
+                    }
 
-                        // std::cout << "?_ " << (v+1) << " -> " << (p+1) << std::endl;
+                    if (Ld(x, ptV, verts[w].pt)) {
+                        p = w;
+                        w = verts[w].nxt;
 
-                        double *ptW = verts.at(w).pt;
+                        vtkbool_throw(w != NO_USE, "GetVisPoly", noElem);
+                    }
 
-                        double cC = Cross(x, ptV, ptW),
-                            cD = Cross(ptV, ptU, ptW);
+                    // std::cout << "?_ " << (v+1) << " -> " << (p+1) << std::endl;
 
-                        /*std::cout << "?_ cC " << cC << std::endl;
-                        std::cout << "?_ cD " << cD << std::endl;*/
+                    double *ptW = verts[w].pt;
 
-                        if (cC < 0) {
+                    double cC = Cross(x, ptV, ptW),
+                        cD = Cross(ptV, ptU, ptW);
 
-                            if (cD < 0 || IsNear(ptU, ptW)) {
-                                verts.at(vp.back()).nxt = p;
+                    /*std::cout << "?_ cC " << cC << std::endl;
+                    std::cout << "?_ cD " << cD << std::endl;*/
 
-                                vp.push_back(p);
+                    if (cC < 0) {
 
-                                verts.at(t).id = NO_USE;
+                        if (cD < 0 || IsNear(ptU, ptW)) {
+                            verts[vp.back()].nxt = p;
 
-                            } else {
-                                int _x = w;
+                            vp.push_back(p);
 
-                                for (;;) {
-                                    Vert &a = verts.at(_x),
-                                        &b = verts.at(a.nxt);
+                            verts[t].id = NO_USE;
 
-                                    double *ptA = a.pt,
-                                        *ptB = b.pt;
+                        } else {
+                            int _x = w;
 
-                                    // std::cout << "?_ 3> " << (_x+1) << ", " << (a.nxt+1) << std::endl;
+                            for (;;) {
+                                int nxt = verts[_x].nxt;
 
-                                    std::shared_ptr<D> d(Intersect(x, verts.at(v).r, ptA, ptB));
+                                vtkbool_throw(nxt != NO_USE, "GetVisPoly", noElem);
 
-                                    if (d
-                                        && (!IsFrontfaced(verts.at(v).r, ptA, ptB)
-                                            || IsNear(ptA, ptV))) { // spezialfall (special:1, ind:1)
+                                Point a = verts[_x],
+                                    b = verts[nxt];
 
-                                        if (d->t2 < E) {
-                                            verts.at(vp.back()).nxt = _x;
-                                            vp.push_back(_x);
+                                double *ptA = a.pt,
+                                    *ptB = b.pt;
 
-                                        } else {
-                                            Point _p(d->s);
+                                // std::cout << "?_ 3> " << (_x+1) << ", " << (nxt+1) << std::endl;
 
-                                            Vert _v(x, _p, ref, a.nxt);
-                                            verts.push_back(_v);
-                                            int k = verts.size()-1;
+                                D d;
 
-                                            verts.at(vp.back()).nxt = k;
+                                if (Intersect(x, verts[v].r, ptA, ptB, d)
+                                    && (!IsFrontfaced(verts[v].r, ptA, ptB)
+                                        || IsNear(ptA, ptV))) { // spezialfall (special:1, ind:1)
 
-                                            vp.push_back(k);
+                                    if (d.t2 < E) {
+                                        verts[vp.back()].nxt = _x;
+                                        vp.push_back(_x);
 
-                                            tr.Track(a, b, _v, d->t2);
+                                    } else {
+                                        Point _p(d.s[0], d.s[1], NO_USE, tr.NewTag());
 
-                                        }
+                                        Vert _v(x, _p, nxt);
 
-                                        break;
-                                    } else {
-                                        _x = a.nxt;
-                                    }
+                                        tr.Track(a, b, _v, d.t2);
 
-                                    vtkbool_throw(_x != NO_USE, "GetVisPoly", "_x not set");
+                                        int k = ws.AddVert(_v);
 
-                                }
-                            }
+                                        verts[vp.back()].nxt = k;
 
-                        } else {
-                            verts.at(vp.back()).nxt = p;
+                                        vp.push_back(k);
 
-                            vp.push_back(p);
-                        }
+                                    }
 
-                    }
-                }
-            }
+                                    break;
+                                } else {
+                                    _x = nxt;
+                                }
 
-            // -
+                            }
+                        }
+
+                    } else {
+                        verts[vp.back()].nxt = p;
 
-            PolyType r;
-            r.push_back(poly[ind]);
+                        vp.push_back(p);
+                    }
 
-            for (int _v : vp) {
-                r.push_back(verts[_v]);
+                }
             }
+        }
 
-            // std::cout << "?F " << _i << " " << GetAbsolutePath(r) << std::endl;
+        /*PolyType r;
+        r.push_back(poly[ind]);
 
+        for (int _v : vp) {
+            r.push_back(verts[_v]);
         }
 
-    } catch (const std::out_of_range&) {
-        vtkbool_throw(false, "GetVisPoly", "cannot access element in verts");
+        std::cout << "?F " << GetAbsolutePath(r) << std::endl;*/
+
     }
 
     res.push_back(poly[ind]);
@@ -464,7 +490,7 @@ void GetVisPoly (PolyType &poly, Tracker &tr, PolyType &res, int ind) {
 m 26.402829,29.895027 -2.132521,24.374833 -3.073759,35.133226 22.541594,1.972134 76.814397,6.720388 1.86346,-21.299507 3.34282,-38.208551 -31.800976,-2.782225 -0.800142,-0.07 -7.246298,-0.633968 -2.155836,24.641314 -6.148254,-0.537902 -8.586643,-0.751234 -4.925747,-0.430947 1.112312,-12.713787 0.198,-2.263145 0.192176,-2.196583 0.326117,-3.727536 0.327231,-3.740264 z
 */
 
-void DouglasPeucker (const PolyType &poly, const CurvsType curvs, FeatureTagsType &tags) {
+void DouglasPeucker (const PolyType &poly, const CurvsType &curvs, FeatureTagsType &tags) {
     std::size_t num = poly.size();
 
     std::deque<Pair> pairs;
@@ -515,12 +541,12 @@ void DouglasPeucker (const PolyType &poly, const CurvsType curvs, FeatureTagsTyp
 
 }
 
-void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTags, PolyType &res, int skip, bool rev) {
-    PolyType poly2;
-
+Simplifier::Simplifier (const PolyType &_poly) : poly(_poly) {
     PolyType::const_iterator itr, itr2, itr3;
 
     for (itr = poly.begin(); itr != poly.end(); ++itr) {
+        pos.emplace(itr->tag, itr-poly.begin());
+
         itr2 = itr+1;
 
         if (itr2 == poly.end()) {
@@ -528,11 +554,12 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
         }
 
         if (!IsNear(itr->pt, itr2->pt)) {
+            pos2.emplace(itr->tag, poly2.size());
             poly2.push_back(*itr);
         }
     }
 
-    std::vector<Curv> curvs;
+    std::vector<Curv> _curvs;
 
     for (itr = poly2.begin(); itr != poly2.end(); ++itr) {
         itr2 = itr+1;
@@ -549,37 +576,29 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
 
         double c = GetCurv(*itr, *itr2, *itr3);
 
-        curvs.emplace_back(itr2->tag, std::abs(c));
+        _curvs.emplace_back(itr2->tag, std::abs(c));
 
     }
 
-    std::sort(curvs.begin(), curvs.end());
-
-    CurvsType _curvs;
+    std::sort(_curvs.begin(), _curvs.end());
 
-    for (const Curv &c : curvs) {
-        _curvs.emplace(c.tag, c.c);
+    for (const Curv &c : _curvs) {
+        curvs.emplace(c.tag, c.c);
     }
 
     PolyType polyA(poly2), polyB(poly2);
 
-    int a = curvs.begin()->tag,
+    int a = _curvs.begin()->tag,
         b = 0;
 
     // a und b dürfen nicht an gleicher stelle sein
 
-    std::map<int, Point> _map;
-
-    for (const Point &p : poly2) {
-        _map.emplace(p.tag, p);
-    }
-
     std::set<Point> _pts(poly2.begin(), poly2.end());
 
     std::vector<Curv>::const_iterator itr4;
 
-    for (itr4 = curvs.begin()+1; itr4 != curvs.end(); ++itr4) {
-        if (_pts.find(_map.at(a)) != _pts.find(_map.at(itr4->tag)) ) {
+    for (itr4 = _curvs.begin()+1; itr4 != _curvs.end(); ++itr4) {
+        if (_pts.find(poly2[pos2.at(a)]) != _pts.find(poly2[pos2.at(itr4->tag)]) ) {
             b = itr4->tag;
             break;
         }
@@ -590,12 +609,8 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
     GetSect(a, b, polyA);
     GetSect(b, a, polyB);
 
-    FeatureTagsType tags;
-
-    DouglasPeucker(polyA, _curvs, tags);
-    DouglasPeucker(polyB, _curvs, tags);
-
-    tags.insert(skip);
+    DouglasPeucker(polyA, curvs, tags);
+    DouglasPeucker(polyB, curvs, tags);
 
     /*for (auto tag : tags) {
         std::cout << tag << std::endl;
@@ -603,7 +618,7 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
 
     // sucht nach bestimmten punkten außerhalb der tags
 
-    SpecTagsPtr _specTags(new SpecTagsType);
+    specs = std::make_shared<SpecTagsType>();
 
     std::set<Point> pts;
 
@@ -615,7 +630,32 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
 
     for (auto &p : poly2) {
         if (tags.count(p.tag) == 0 && pts.count(p) == 1) {
-            _specTags->insert(p.tag);
+            specs->insert(p.tag);
+        }
+    }
+
+}
+
+void Simplifier::GetSimplified (SavedPtsPtr &savedPts, SpecTagsPtr &specTags, PolyType &res, int skip, bool rev) {
+    // skip kommt zu den tags hinzu, ändert aber nur etwas, wenn er noch keiner ist
+
+    bool extra = tags.count(skip) == 0 && pos2.count(skip) == 1;
+
+    SpecTagsPtr _specTags(specs);
+
+    if (extra) {
+        const Point &s = poly2[pos2.at(skip)];
+
+        _specTags = std::make_shared<SpecTagsType>(*specs);
+        _specTags->erase(skip);
+
+        for (auto &p : poly2) {
+            if (p.tag != skip
+                && tags.count(p.tag) == 0
+                && !(p < s) && !(s < p)) {
+
+                _specTags->insert(p.tag);
+            }
         }
     }
 
@@ -623,8 +663,8 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
         specTags.swap(_specTags);
     }
 
-    std::copy_if(poly2.begin(), poly2.end(), std::back_inserter(res), [&tags, &specTags](const Point &p) {
-        return tags.count(p.tag) == 1 || (specTags && specTags->count(p.tag) == 1);
+    std::copy_if(poly2.begin(), poly2.end(), std::back_inserter(res), [&](const Point &p) {
+        return tags.count(p.tag) == 1 || p.tag == skip || (specTags && specTags->count(p.tag) == 1);
     });
 
     /*for (auto &r : res) {
@@ -636,62 +676,84 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
     // sichert die gelöschten punkte
 
     if (savedPts) {
-        std::vector<PolyType> sects;
-
-        for (itr = res.begin(); itr != res.end(); ++itr) {
-            itr2 = itr+1;
+        if (extra) {
+            savedPts = std::make_shared<SavedPtsType>();
+            Save(res, rev, *savedPts);
+        } else {
+            SavedPtsPtr &_saved = saved[(rev ? 1 : 0)+(specTags ? 2 : 0)];
 
-            if (itr2 == res.end()) {
-                itr2 = res.begin();
+            if (!_saved) {
+                _saved = std::make_shared<SavedPtsType>();
+                Save(res, rev, *_saved);
             }
 
-            PolyType sect(poly); // kopiert
-            GetSect(itr->tag, itr2->tag, sect);
+            savedPts = _saved;
+        }
+    }
+
+}
+
+void Simplifier::Save (const PolyType &res, bool rev, SavedPtsType &savedPts) const {
+    int num = poly.size();
+
+    PolyType::const_iterator itr, itr2;
+
+    for (itr = res.begin(); itr != res.end(); ++itr) {
+        itr2 = itr+1;
 
-            sects.push_back(std::move(sect));
+        if (itr2 == res.end()) {
+            itr2 = res.begin();
         }
 
-        for (auto &sect : sects) {
-            if (sect.size() > 2) {
-                const Point &a = *sect.begin(),
-                    &b = *sect.rbegin();
+        // der abschnitt von itr bis itr2 in poly, ohne ihn zu kopieren
 
-                double n[] = {b.x-a.x, b.y-a.y},
-                    l = Normalize(n);
+        int i = pos.at(itr->tag),
+            j = pos.at(itr2->tag);
 
-                double d = a.x*n[0]+a.y*n[1];
+        int len = (j-i+num)%num+1;
 
-                VertsType4 verts;
+        if (len > 2) {
+            const Point &a = poly[i],
+                &b = poly[j];
 
-                for (itr = sect.begin()+1; itr != sect.end()-1; ++itr) {
-                    const Point &_p = *itr;
+            double n[] = {b.pt[0]-a.pt[0], b.pt[1]-a.pt[1]},
+                l = Normalize(n);
 
-                    double t = _p.x*n[0]+_p.y*n[1]-d;
+            double d = a.pt[0]*n[0]+a.pt[1]*n[1];
 
-                    //assert(t/l > 0 && t/l < 1);
+            VertsType4 verts;
 
-                    Vert4 v(_p, t/l);
+            for (int k = 1; k < len-1; k++) {
+                const Point &_p = poly[(i+k)%num];
 
-                    v.pt[0] = a.x+t*n[0];
-                    v.pt[1] = a.y+t*n[1];
+                double t = _p.pt[0]*n[0]+_p.pt[1]*n[1]-d;
 
-                    if (rev) {
-                        v.t = 1-v.t;
-                    }
+                //assert(t/l > 0 && t/l < 1);
 
-                    verts.push_back(std::move(v));
-                }
+                Vert4 v(_p, t/l);
+
+                v.pt[0] = a.pt[0]+t*n[0];
+                v.pt[1] = a.pt[1]+t*n[1];
 
                 if (rev) {
-                    std::reverse(verts.begin(), verts.end());
-                    (*savedPts)[{b.tag, a.tag}] = verts;
-                } else {
-                    (*savedPts)[{a.tag, b.tag}] = verts;
+                    v.t = 1-v.t;
                 }
+
+                verts.push_back(std::move(v));
+            }
+
+            if (rev) {
+                std::reverse(verts.begin(), verts.end());
+                savedPts[{b.tag, a.tag}] = verts;
+            } else {
+                savedPts[{a.tag, b.tag}] = verts;
             }
         }
     }
+}
 
+void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTags, PolyType &res, int skip, bool rev) {
+    Simplifier(poly).GetSimplified(savedPts, specTags, res, skip, rev);
 }
 
 /*void Align (PolyType &poly, const Point &p) {
@@ -701,7 +763,7 @@ void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTag
 
     for (itr = poly.begin(); itr != poly.end(); ++itr) {
         if (itr->id != p.id) {
-            double v[] = {itr->x-p.x, itr->y-p.y};
+            double v[] = {itr->pt[0]-p.pt[0], itr->pt[1]-p.pt[1]};
             verts.push_back({static_cast<int>(itr-poly.begin()), Normalize(v)});
         }
     }
@@ -743,8 +805,8 @@ void Restore (const PolyType &poly, const Tracker &tr, const SavedPtsType &saved
             continue;
         }
 
-        const Pos &posA = tr.locs.at(itr->tag),
-            &posB = tr.locs.at(itr2->tag);
+        const Pos &posA = tr.Get(itr->tag),
+            &posB = tr.Get(itr2->tag);
 
         if (savedPts.find({ posA.edA, posA.edB }) != savedPts.end()
             && (posA == posB
@@ -862,11 +924,23 @@ void SimpleRestore (const PolyType &poly, const SavedPtsType &savedPts, PolyType
 }
 
 void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind) {
+    VisPolyWs ws;
+    GetVisPoly_wrapper(poly, res, ind, ws);
+}
+
+void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind, VisPolyWs &ws) {
     int i = 0;
     for (auto& p : poly) {
+        p.tag = i;
         p.id = i++;
     }
 
+    Simplifier simp(poly);
+
+    GetVisPoly_wrapper(poly, res, ind, ws, simp);
+}
+
+void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind, VisPolyWs &ws, Simplifier &simp) {
     vtkbool_throw(TestCW(poly), "GetVisPoly_wrapper", "poly not clockwise");
 
     /*std::cout << "?" << std::endl
@@ -881,26 +955,28 @@ void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind) {
 
     SpecTagsPtr specTags(new SpecTagsType);
 
-    Simplify(poly, savedPts, specTags, poly2, x.tag, true);
+    simp.GetSimplified(savedPts, specTags, poly2, x.tag, true);
 
     // Align(poly2, x);
 
-    Tracker tr(poly2);
+    Tracker tr(poly2, poly.size());
 
     TrivialRm(poly2, tr, ind, x).GetSimplified(poly3);
 
     // std::cout << "?D " << GetAbsolutePath(poly3) << std::endl;
 
     try {
-        GetVisPoly(poly3, tr, poly4);
+        GetVisPoly(poly3, tr, poly4, ws);
 
-        for (auto &l : tr.locs) {
-            vtkbool_throw(l.second.t < 1, "GetVisPoly_wrapper", "t not less than 1");
+        vtkbool_throw(poly4.size() > 2, "GetVisPoly_wrapper", "poly4 is degenerated");
+
+        for (const Pos &pos : tr.GetLocs()) {
+            vtkbool_throw(pos.edA == NO_USE || pos.t < 1, "GetVisPoly_wrapper", "t not less than 1");
         }
 
         /*i = 0;
         for (auto &p : poly4) {
-            std::cout << i++ << ". " << p << " => " << tr.locs[p.tag] << std::endl;
+            std::cout << i++ << ". " << p << " => " << tr.Get(p.tag) << std::endl;
         }*/
 
         if (specTags->count(poly4[1].tag) == 1) {
@@ -978,9 +1054,7 @@ void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind) {
 
         // trivialer test ob sich die linien innerhalb von res überschneiden
 
-        AABB tree;
-
-        std::vector<std::shared_ptr<Line>> lines;
+        std::vector<Line> lines;
 
         PolyType::const_iterator itr, itr2;
 
@@ -993,37 +1067,29 @@ void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind) {
                 itr2 = res.begin();
             }
 
-            lines.emplace_back(new Line({*itr}, {*itr2}));
+            lines.push_back(Line({*itr}, {*itr2}));
 
             pts.insert(*itr);
 
         }
 
-        for (auto &line : lines) {
-            tree.InsertObj(line);
-        }
+        AABB<Line> tree(lines);
 
         Bnds bnds(-E, E, -E, E);
 
-        for (auto &lineA : lines) {
-            auto found = tree.Search(lineA);
-            const Line &lA = *lineA;
-
-            for (auto &lineB : found) {
-                const Line &lB = dynamic_cast<Line&>(*lineB);
-
+        for (const Line &lA : lines) {
+            bool found = tree.Search(lA.bb, [&](const Line &lB) {
                 // die linien dürfen sich nicht an den enden berühren
 
-                if (pts.find(lA.pA) != pts.find(lB.pA)
+                return pts.find(lA.pA) != pts.find(lB.pA)
                     && pts.find(lA.pA) != pts.find(lB.pB)
                     && pts.find(lA.pB) != pts.find(lB.pA)
                     && pts.find(lA.pB) != pts.find(lB.pB)
 
-                    && Intersect2(lA.pA.pt, lA.pB.pt, lB.pA.pt, lB.pB.pt, bnds)) {
+                    && Intersect2(lA.pA.pt, lA.pB.pt, lB.pA.pt, lB.pB.pt, bnds);
+            });
 
-                    vtkbool_throw(false, "GetVisPoly_wrapper", "res is invalid - intersecting edges");
-                }
-            }
+            vtkbool_throw(!found, "GetVisPoly_wrapper", "res is invalid - intersecting edges");
         }
 
         // alles gut
@@ -29,19 +29,15 @@ limitations under the License.
 
 class Vert : public Point {
 public:
-    double r[2], phi;
+    double r[2];
     int nxt;
 
-    Vert (double *_x, Point &p) : Point(p), nxt(NO_USE) {
+    Vert (double *_x, const Point &p, int _nxt = NO_USE) : Point(p), nxt(_nxt) {
         r[0] = pt[0]-_x[0];
         r[1] = pt[1]-_x[1];
 
         Normalize(r);
     }
-    Vert (double *_x, Point &p, double *ref, int _nxt = NO_USE) : Vert(_x, p) {
-        nxt = _nxt;
-        phi = GetAngle(ref, r);
-    }
 
     friend std::ostream& operator<< (std::ostream &out, const Vert &v) {
         out << (Point) v
@@ -55,21 +51,80 @@ typedef std::vector<Vert> VertsType;
 
 class Bag {
 public:
-    Bag (int _f, int _g, double _phi) : f(_f), g(_g), phi(_phi) {
+    Bag (int _f, int _g) : f(_f), g(_g) {
 
     }
 
+    // der winkel ist der von f
     int f, g;
-    double phi;
 
     friend std::ostream& operator<< (std::ostream &out, const Bag &b) {
-        out << "phi: " << b.phi
-            << ", f: " << (b.f+1)
+        out << "f: " << (b.f+1)
             << ", g: " << (b.g+1);
         return out;
     }
 };
 
+// puffer von GetVisPoly, bleiben über mehrere aufrufe erhalten
+
+class VisPolyWs {
+public:
+    VertsType verts;
+    IdsType vp;
+    std::vector<Bag> leftBags;
+
+    // ersetzte punkte beim skipping, NO_USE falls keiner
+    IdsType repl;
+
+    // richtung zum ersten punkt, von dort aus wird gegen den uhrzeigersinn gezählt
+    double ref[2];
+
+    void Clear () {
+        verts.clear();
+        vp.clear();
+        leftBags.clear();
+        repl.clear();
+    }
+
+    int AddVert (const Vert &v) {
+        verts.push_back(v);
+        repl.push_back(NO_USE);
+        return verts.size()-1;
+    }
+
+    // entspricht phi(a) > phi(b) || |phi(a)-phi(b)| < E, ohne die winkel zu berechnen
+    bool IsNotBefore (int a, int b) const {
+        const double *rA = verts[a].r,
+            *rB = verts[b].r;
+
+        int hA = GetHalf(rA),
+            hB = GetHalf(rB);
+
+        double c = rB[0]*rA[1]-rB[1]*rA[0],
+            d = rA[0]*rB[0]+rA[1]*rB[1];
+
+        bool near = d > 0 && std::abs(c) < E;
+
+        if (hA == hB) {
+            return c > 0 || near;
+        }
+
+        // über ref hinweg sind sie nie nahe beieinander, nur um pi herum
+        if (near && rA[0]*ref[0]+rA[1]*ref[1] < 0) {
+            return true;
+        }
+
+        return hA > hB;
+    }
+
+private:
+    // 0 für phi in [0, pi), 1 für [pi, 2*pi)
+    int GetHalf (const double *r) const {
+        double c = ref[0]*r[1]-ref[1]*r[0];
+        return (c > 0 || (c == 0 && ref[0]*r[0]+ref[1]*r[1] >= 0)) ? 0 : 1;
+    }
+};
+
 class Vert2 {
 public:
     Vert2 (int _i, double _l) : i(_i), l(_l) {}
@@ -99,23 +154,58 @@ public:
 };
 
 class Tracker {
+    int nextTag, base;
+
+    // locs[tag-base], edA ist NO_USE wenn der tag nicht verfolgt wird
+    std::vector<Pos> locs;
+
 public:
-    std::map<int, Pos> locs;
-    Tracker (const PolyType &poly) {
+    // nextTag muss größer als alle tags der ursprünglichen punkte sein
+    Tracker (const PolyType &poly, int _nextTag) : nextTag(_nextTag), base(_nextTag) {
+        for (const Point &p : poly) {
+            base = std::min(base, p.tag);
+        }
+
+        locs.assign(nextTag-base, Pos(NO_USE, NO_USE, 0));
+
         PolyType::const_reverse_iterator itr;
         for (itr = poly.rbegin(); itr != poly.rend(); ++itr) {
-            locs[itr->tag] = { itr->tag, (itr+1 != poly.rend() ? itr+1 : poly.rbegin())->tag, 0 };
+            locs[itr->tag-base] = { itr->tag, (itr+1 != poly.rend() ? itr+1 : poly.rbegin())->tag, 0 };
         }
     }
+
+    // für die neu berechneten schnittpunkte
+    int NewTag () {
+        locs.emplace_back(NO_USE, NO_USE, 0);
+        return nextTag++;
+    }
+
+    bool Has (int tag) const {
+        return tag >= base
+            && tag < nextTag
+            && locs[tag-base].edA != NO_USE;
+    }
+
+    const Pos& Get (int tag) const {
+        vtkbool_throw(Has(tag), "Tracker", "tag not tracked");
+        return locs[tag-base];
+    }
+
+    const std::vector<Pos>& GetLocs () const {
+        return locs;
+    }
+
     void Track (const Point &before, const Point &after, const Point &p, double t) {
-        try {
-            const Pos &posB = locs.at(before.tag), // xxx
-                &posA = locs.at(after.tag); // xxx
+        if (!Has(before.tag) || !Has(after.tag) || p.tag < base || p.tag >= nextTag) {
+            return;
+        }
 
-            double tA = posB == posA ? posA.t : 1;
+        const Pos &posB = locs[before.tag-base],
+            &posA = locs[after.tag-base];
 
-            locs[p.tag] = { posB.edA, posB.edB, posB.t+(tA-posB.t)*t };
-        } catch(...) {}
+        double tA = posB == posA ? posA.t : 1;
+
+        locs[p.tag-base] = { posB.edA, posB.edB, posB.t+(tA-posB.t)*t };
     }
 
 };
@@ -134,7 +224,7 @@ public:
 typedef std::map<int, double> CurvsType;
 
 inline double GetCurv (const Point &a, const Point &b, const Point &c) {
-    return (a.x*b.y-b.x*a.y)+(b.x*c.y-c.x*b.y)+(c.x*a.y-a.x*c.y);
+    return (a.pt[0]*b.pt[1]-b.pt[0]*a.pt[1])+(b.pt[0]*c.pt[1]-c.pt[0]*b.pt[1])+(c.pt[0]*a.pt[1]-a.pt[0]*c.pt[1]);
 }
 
 typedef std::set<int> FeatureTagsType;
@@ -159,6 +249,32 @@ typedef std::shared_ptr<SavedPtsType> SavedPtsPtr;
 typedef std::set<int> SpecTagsType;
 typedef std::shared_ptr<SpecTagsType> SpecTagsPtr;
 
+// vorverarbeitung eines polygons, die nicht vom punkt der abfrage abhängt
+// wird einmal pro polygon erstellt und von allen sichtbarkeitsabfragen geteilt
+
+class Simplifier {
+    PolyType poly, poly2;
+
+    // index eines tags in poly bzw. poly2
+    std::map<int, int> pos, pos2;
+
+    CurvsType curvs;
+    FeatureTagsType tags;
+
+    // punkte außerhalb der tags, die mit einem getaggten punkt zusammenfallen
+    SpecTagsPtr specs;
+
+    // gesicherte punkte für skip in tags, nach rev und specTags
+    SavedPtsPtr saved[4];
+
+    void Save (const PolyType &res, bool rev, SavedPtsType &savedPts) const;
+
+public:
+    Simplifier (const PolyType &_poly);
+
+    void GetSimplified (SavedPtsPtr &savedPts, SpecTagsPtr &specTags, PolyType &res, int skip, bool rev);
+};
+
 void Simplify (const PolyType &poly, SavedPtsPtr &savedPts, SpecTagsPtr &specTags, PolyType &res, int skip, bool rev);
 
 // void Align (PolyType &poly, const Point &p);
@@ -169,8 +285,11 @@ void Restore2 (const PolyType &poly, PolyType &res);
 void SimpleRestore (const PolyType &poly, const SavedPtsType &savedPts, PolyType &res);
 
 // diese darf nicht direkt verwendet werden
-void GetVisPoly (PolyType &poly, Tracker &tr, PolyType &res, int ind = 0);
+void GetVisPoly (PolyType &poly, Tracker &tr, PolyType &res, VisPolyWs &ws, int ind = 0);
 
+// die tags von poly müssen den indexen entsprechen, simp muss aus poly erstellt worden sein
+void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind, VisPolyWs &ws, Simplifier &simp);
+void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind, VisPolyWs &ws);
 void GetVisPoly_wrapper (PolyType &poly, PolyType &res, int ind);
 
 #endif
@@ -0,0 +1,111 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+
+#include "Predicates.h"
+
+// vergleicht die adaptiven prädikate mit der einfachen auswertung
+
+typedef std::chrono::steady_clock Clock;
+
+double Measure (const std::function<int()> &f, int &res) {
+    auto start = Clock::now();
+    res = f();
+    return std::chrono::duration<double, std::milli>(Clock::now()-start).count();
+}
+
+int main () {
+    const int num = 1000000;
+
+    std::mt19937_64 gen(1);
+    std::uniform_real_distribution<double> dist(-1, 1);
+
+    std::vector<double> rand(num*14), degen(num*14);
+
+    for (int i = 0; i < num*14; i++) {
+        rand[i] = dist(gen);
+    }
+
+    // d liegt (bis auf rundung) in der ebene durch a, b, c
+    for (int i = 0; i < num; i++) {
+        double *p = degen.data()+i*14;
+
+        for (int j = 0; j < 9; j++) {
+            p[j] = dist(gen);
+        }
+
+        double s = dist(gen), t = dist(gen);
+
+        for (int j = 0; j < 3; j++) {
+            p[9+j] = p[j]+s*(p[3+j]-p[j])+t*(p[6+j]-p[j]);
+        }
+
+        // für orient2d: auf der geraden durch a und b
+        for (int j = 0; j < 2; j++) {
+            p[12+j] = p[j]+s*(p[3+j]-p[j]);
+        }
+    }
+
+    for (auto &data : {std::cref(rand), std::cref(degen)}) {
+        const std::vector<double> &pts = data.get();
+
+        auto Run = [&](double (*orient) (const double*, const double*, const double*, const double*)) {
+            return [&pts, orient]() {
+                int s = 0;
+                for (int i = 0; i < num; i++) {
+                    const double *p = pts.data()+i*14;
+                    s += Sign(orient(p, p+3, p+6, p+9));
+                }
+                return s;
+            };
+        };
+
+        auto Run2 = [&](double (*orient) (const double*, const double*, const double*)) {
+            return [&pts, orient]() {
+                int s = 0;
+                for (int i = 0; i < num; i++) {
+                    const double *p = pts.data()+i*14;
+                    double c[] = {p[12], p[13]};
+                    s += Sign(orient(p, p+3, c));
+                }
+                return s;
+            };
+        };
+
+        int resA, resB;
+
+        double tA = Measure(Run2(Orient2dFast), resA),
+            tB = Measure(Run2(Orient2d), resB);
+
+        std::cout << (&pts == &rand ? "random" : "degenerate") << std::endl;
+
+        std::cout << "  orient2d: fast " << tA << "ms, adaptive " << tB << "ms (x" << tB/tA << ")"
+            << ", sums " << resA << ", " << resB << std::endl;
+
+        tA = Measure(Run(Orient3dFast), resA);
+        tB = Measure(Run(Orient3d), resB);
+
+        std::cout << "  orient3d: fast " << tA << "ms, adaptive " << tB << "ms (x" << tB/tA << ")"
+            << ", sums " << resA << ", " << resB << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#include "VisPoly.h"
+
+// misst GetVisPoly_wrapper auf polygonen mit 10k punkten
+
+typedef std::chrono::steady_clock Clock;
+
+// stern mit zufälligen zacken, im uhrzeigersinn
+void Star (int num, std::mt19937 &gen, PolyType &poly) {
+    std::uniform_real_distribution<double> dist(.5, .9);
+
+    for (int i = 0; i < num; i++) {
+        double phi = -2*PI*i/num,
+            r = i%2 == 0 ? 1 : dist(gen);
+
+        poly.push_back(Point(r*std::cos(phi), r*std::sin(phi), i));
+    }
+}
+
+// kamm mit zähnen nach oben, im uhrzeigersinn
+void Comb (int num, std::mt19937 &gen, PolyType &poly) {
+    std::uniform_real_distribution<double> dist(.2, 1);
+
+    int i = 0, n = (num-2)/2;
+
+    poly.push_back(Point(0, 0, i++));
+
+    for (int j = 0; j < n; j++) {
+        double h = dist(gen);
+
+        poly.push_back(Point(j, h, i++));
+        poly.push_back(Point(j+.5, h+1, i++));
+    }
+
+    poly.push_back(Point(n, 0, i++));
+}
+
+int main () {
+    const int num = 10000, queries = 5;
+
+    std::mt19937 gen(1);
+
+    std::vector<std::pair<std::string, PolyType>> polys(2);
+
+    polys[0].first = "star";
+    Star(num, gen, polys[0].second);
+
+    polys[1].first = "comb";
+    Comb(num, gen, polys[1].second);
+
+    for (auto &p : polys) {
+        PolyType &poly = p.second;
+
+        // die tags müssen den indexen entsprechen
+        for (Point &pt : poly) {
+            pt.tag = pt.id;
+        }
+
+        std::cout << p.first << " (" << poly.size() << " points)" << std::endl;
+
+        for (bool shared : {false, true}) {
+            VisPolyWs ws;
+
+            std::unique_ptr<Simplifier> simp;
+
+            double total = 0;
+
+            int failed = 0;
+            std::size_t pts = 0;
+
+            // reflexe punkte, gleichmäßig verteilt
+            for (int i = 0; i < queries; i++) {
+                int ind = (i*(num/queries))|1;
+
+                PolyType res;
+
+                auto start = Clock::now();
+
+                // ohne teilen wird die vorverarbeitung bei jeder abfrage wiederholt
+                if (!shared || !simp) {
+                    simp.reset(new Simplifier(poly));
+                }
+
+                try {
+                    GetVisPoly_wrapper(poly, res, ind, ws, *simp);
+                    pts += res.size();
+                } catch (const std::exception &e) {
+                    failed++;
+                }
+
+                total += std::chrono::duration<double, std::milli>(Clock::now()-start).count();
+            }
+
+            std::cout << "  " << (shared ? "shared" : "per query") << ": "
+                << total/queries << "ms per query"
+                << ", " << pts << " points in results"
+                << ", " << failed << " failed" << std::endl;
+        }
+    }
+
+    return 0;
+}
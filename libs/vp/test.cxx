@@ -26,8 +26,6 @@ limitations under the License.
 
 #include "VisPoly.h"
 
-int Point::_tag = 0;
-
 void ToPoly (const Json::Value& pts, PolyType &poly) {
     int i = 0;
 
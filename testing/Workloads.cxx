@@ -0,0 +1,341 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkSphereSource.h>
+#include <vtkCubeSource.h>
+#include <vtkCylinderSource.h>
+#include <vtkParametricTorus.h>
+#include <vtkParametricFunctionSource.h>
+#include <vtkTriangleFilter.h>
+#include <vtkLinearSubdivisionFilter.h>
+#include <vtkAppendPolyData.h>
+#include <vtkPolyDataWriter.h>
+#include <vtkSTLWriter.h>
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Workloads.h"
+#include "vtkPolyDataBooleanFilter.h"
+
+double Uniform (std::mt19937 &gen, double a, double b) {
+    // die ausgabe von mt19937 ist durch den standard festgelegt
+    return a+(b-a)*(gen()/4294967296.);
+}
+
+vtkSmartPointer<vtkPolyData> MakeSphere (vtkIdType cells, const double *center, double r) {
+    // 2*res*(res-1) dreiecke
+    int res = std::max(4, static_cast<int>(std::sqrt(cells/2.)+.5));
+
+    vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+    sphere->SetCenter(center[0], center[1], center[2]);
+    sphere->SetRadius(r);
+    sphere->SetThetaResolution(res);
+    sphere->SetPhiResolution(res);
+    sphere->Update();
+
+    return sphere->GetOutput();
+}
+
+vtkSmartPointer<vtkPolyData> MakeTorus (vtkIdType cells, const double *center, double ringR, double crossR) {
+    // 2*u*v dreiecke, u ist dreimal so groß wie v
+    int v = std::max(6, static_cast<int>(std::sqrt(cells/6.)+.5)),
+        u = std::max(8, static_cast<int>(cells/(2.*v)+.5));
+
+    vtkSmartPointer<vtkParametricTorus> torus = vtkSmartPointer<vtkParametricTorus>::New();
+    torus->SetRingRadius(ringR);
+    torus->SetCrossSectionRadius(crossR);
+
+    vtkSmartPointer<vtkParametricFunctionSource> source = vtkSmartPointer<vtkParametricFunctionSource>::New();
+    source->SetParametricFunction(torus);
+    source->SetUResolution(u);
+    source->SetVResolution(v);
+    source->Update();
+
+    vtkSmartPointer<vtkPolyData> pd = source->GetOutput();
+
+    vtkPoints *pts = pd->GetPoints();
+
+    double pt[3];
+
+    for (vtkIdType i = 0; i < pts->GetNumberOfPoints(); i++) {
+        pts->GetPoint(i, pt);
+        pts->SetPoint(i, pt[0]+center[0], pt[1]+center[1], pt[2]+center[2]);
+    }
+
+    return pd;
+}
+
+vtkSmartPointer<vtkPolyData> MakeBox (vtkIdType cells, const double *bnds) {
+    // 12*4^level dreiecke
+    int level = std::max(0, static_cast<int>(std::log(cells/12.)/std::log(4.)+.5));
+
+    vtkSmartPointer<vtkCubeSource> cube = vtkSmartPointer<vtkCubeSource>::New();
+    cube->SetBounds(bnds[0], bnds[1], bnds[2], bnds[3], bnds[4], bnds[5]);
+
+    vtkSmartPointer<vtkTriangleFilter> tf = vtkSmartPointer<vtkTriangleFilter>::New();
+    tf->SetInputConnection(cube->GetOutputPort());
+    tf->Update();
+
+    if (level == 0) {
+        return tf->GetOutput();
+    }
+
+    vtkSmartPointer<vtkLinearSubdivisionFilter> sf = vtkSmartPointer<vtkLinearSubdivisionFilter>::New();
+    sf->SetInputConnection(tf->GetOutputPort());
+    sf->SetNumberOfSubdivisions(level);
+    sf->Update();
+
+    return sf->GetOutput();
+}
+
+void MoveRandomly (vtkPolyData *pd, std::mt19937 &gen, double shift) {
+    double axis[3], l;
+
+    do {
+        axis[0] = Uniform(gen, -1, 1);
+        axis[1] = Uniform(gen, -1, 1);
+        axis[2] = Uniform(gen, -1, 1);
+
+        l = vtkMath::Norm(axis);
+    } while (l < 1e-3 || l > 1);
+
+    vtkMath::MultiplyScalar(axis, 1/l);
+
+    double phi = Uniform(gen, 0, 2*vtkMath::Pi()),
+        c = std::cos(phi),
+        s = std::sin(phi);
+
+    double t[3];
+
+    for (int i = 0; i < 3; i++) {
+        t[i] = Uniform(gen, -shift, shift);
+    }
+
+    // drehung nach rodrigues um den schwerpunkt der bounds
+
+    double bnds[6];
+    pd->GetBounds(bnds);
+
+    double o[] = {(bnds[0]+bnds[1])/2, (bnds[2]+bnds[3])/2, (bnds[4]+bnds[5])/2};
+
+    vtkPoints *pts = pd->GetPoints();
+
+    double pt[3], cr[3], r[3];
+
+    for (vtkIdType i = 0; i < pts->GetNumberOfPoints(); i++) {
+        pts->GetPoint(i, pt);
+        vtkMath::Subtract(pt, o, pt);
+
+        vtkMath::Cross(axis, pt, cr);
+
+        double d = vtkMath::Dot(axis, pt);
+
+        for (int j = 0; j < 3; j++) {
+            r[j] = pt[j]*c+cr[j]*s+axis[j]*d*(1-c)+o[j]+t[j];
+        }
+
+        pts->SetPoint(i, r);
+    }
+
+    pd->Modified();
+}
+
+const std::vector<std::string>& GetWorkloadKinds () {
+    static const std::vector<std::string> kinds {"spheres", "tori", "holes", "coplanar", "sweep"};
+    return kinds;
+}
+
+Workload MakeWorkload (const std::string &kind, vtkIdType cells, unsigned int seed) {
+    std::mt19937 gen(seed);
+
+    Workload w;
+    w.kind = kind;
+
+    vtkIdType half = std::max<vtkIdType>(cells/2, 12);
+
+    if (kind == "spheres") {
+        // die zweite kugel ist in eine zufällige richtung verschoben
+
+        double o[] = {0, 0, 0}, d[3], l;
+
+        do {
+            d[0] = Uniform(gen, -1, 1);
+            d[1] = Uniform(gen, -1, 1);
+            d[2] = Uniform(gen, -1, 1);
+
+            l = vtkMath::Norm(d);
+        } while (l < 1e-3 || l > 1);
+
+        vtkMath::MultiplyScalar(d, Uniform(gen, .3, .6)/l);
+
+        w.pdA = MakeSphere(half, o, .5);
+        w.pdB = MakeSphere(half, d, .5);
+        w.operMode = OPER_UNION;
+
+    } else if (kind == "tori") {
+        double o[] = {0, 0, 0};
+
+        w.pdA = MakeTorus(half, o, 1, .3);
+        w.pdB = MakeTorus(half, o, 1, .3);
+
+        MoveRandomly(w.pdB, gen, .5);
+
+        w.operMode = OPER_UNION;
+
+    } else if (kind == "holes") {
+        // platte in der xz-ebene, die zylinder stehen in y-richtung
+
+        double bnds[] = {-2, 2, -.1, .1, -2, 2};
+
+        w.pdA = MakeBox(half, bnds);
+
+        // ein zylinder mit 32 seiten hat 34 zellen
+        int n = static_cast<int>(std::max<vtkIdType>(1, half/34)),
+            k = static_cast<int>(std::ceil(std::sqrt(n)));
+
+        double size = 4./k;
+
+        std::vector<int> slots(k*k);
+        for (int i = 0; i < k*k; i++) {
+            slots[i] = i;
+        }
+
+        // eigenes fisher-yates, std::shuffle ist nicht auf allen plattformen gleich
+        for (int i = k*k-1; i > 0; i--) {
+            std::swap(slots[i], slots[static_cast<int>(Uniform(gen, 0, i+1))]);
+        }
+
+        // die zylinder sind kopien einer vorlage, eine pipeline pro zylinder wäre bei vielen bohrungen zu langsam
+
+        vtkSmartPointer<vtkCylinderSource> cyl = vtkSmartPointer<vtkCylinderSource>::New();
+        cyl->SetResolution(32);
+        cyl->SetRadius(.3*size);
+        cyl->SetHeight(.6);
+        cyl->Update();
+
+        vtkPolyData *tmpl = cyl->GetOutput();
+
+        vtkIdType numPts = tmpl->GetNumberOfPoints();
+
+        vtkSmartPointer<vtkPoints> pts = vtkSmartPointer<vtkPoints>::New();
+        pts->SetDataTypeToDouble();
+
+        vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+
+        vtkSmartPointer<vtkIdList> cell = vtkSmartPointer<vtkIdList>::New();
+
+        double pt[3];
+
+        for (int i = 0; i < n; i++) {
+            int x = slots[i]%k,
+                z = slots[i]/k;
+
+            double cx = -2+size*(x+.5+Uniform(gen, -.1, .1)),
+                cz = -2+size*(z+.5+Uniform(gen, -.1, .1));
+
+            vtkIdType off = pts->GetNumberOfPoints();
+
+            for (vtkIdType j = 0; j < numPts; j++) {
+                tmpl->GetPoint(j, pt);
+                pts->InsertNextPoint(pt[0]+cx, pt[1], pt[2]+cz);
+            }
+
+            for (vtkIdType j = 0; j < tmpl->GetNumberOfCells(); j++) {
+                tmpl->GetCellPoints(j, cell);
+
+                for (vtkIdType l = 0; l < cell->GetNumberOfIds(); l++) {
+                    cell->SetId(l, cell->GetId(l)+off);
+                }
+
+                polys->InsertNextCell(cell);
+            }
+        }
+
+        w.pdB = vtkSmartPointer<vtkPolyData>::New();
+        w.pdB->SetPoints(pts);
+        w.pdB->SetPolys(polys);
+        w.operMode = OPER_DIFFERENCE;
+
+    } else if (kind == "coplanar") {
+        // ein würfel und ein stapel aus scheiben, deren flächen fast koplanar sind
+
+        const int layers = 4;
+
+        double bnds[] = {0, 1, 0, 1, 0, 1};
+
+        w.pdA = MakeBox(half, bnds);
+
+        vtkSmartPointer<vtkAppendPolyData> app = vtkSmartPointer<vtkAppendPolyData>::New();
+
+        for (int i = 0; i < layers; i++) {
+            double slab[] = {.5, 1.5, 0, 1,
+                static_cast<double>(i)/layers+Uniform(gen, 0, 1e-9),
+                static_cast<double>(i+1)/layers-Uniform(gen, 0, 1e-9)};
+
+            app->AddInputData(MakeBox(half/layers, slab));
+        }
+
+        app->Update();
+
+        w.pdB = app->GetOutput();
+        w.operMode = OPER_UNION;
+
+    } else if (kind == "sweep") {
+        // ein torus in zufälliger lage, verschiedene seeds ergeben die bewegung
+
+        double bnds[] = {-1, 1, -1, 1, -1, 1},
+            o[] = {0, 0, 0};
+
+        w.pdA = MakeBox(half, bnds);
+        w.pdB = MakeTorus(half, o, .8, .25);
+
+        MoveRandomly(w.pdB, gen, .5);
+
+        w.operMode = OPER_DIFFERENCE;
+
+    } else {
+        throw std::invalid_argument("unknown workload " + kind);
+    }
+
+    return w;
+}
+
+void WritePolyData (vtkPolyData *pd, const std::string &fileName) {
+    if (fileName.size() > 4 && fileName.compare(fileName.size()-4, 4, ".stl") == 0) {
+        // stl kennt nur dreiecke
+        vtkSmartPointer<vtkTriangleFilter> tf = vtkSmartPointer<vtkTriangleFilter>::New();
+        tf->SetInputData(pd);
+
+        vtkSmartPointer<vtkSTLWriter> writer = vtkSmartPointer<vtkSTLWriter>::New();
+        writer->SetInputConnection(tf->GetOutputPort());
+        writer->SetFileName(fileName.c_str());
+        writer->SetFileTypeToBinary();
+        writer->Update();
+
+    } else {
+        vtkSmartPointer<vtkPolyDataWriter> writer = vtkSmartPointer<vtkPolyDataWriter>::New();
+        writer->SetInputData(pd);
+        writer->SetFileName(fileName.c_str());
+        writer->SetFileTypeToBinary();
+        writer->Update();
+    }
+}
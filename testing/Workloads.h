@@ -0,0 +1,59 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __Workloads_h
+#define __Workloads_h
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <vector>
+#include <string>
+#include <random>
+
+// erzeugt reproduzierbare eingaben für tests und benchmarks
+//
+// cells ist die ungefähre anzahl der zellen beider eingaben zusammen,
+// gleiche werte von cells und seed ergeben auf allen plattformen gleiche eingaben
+
+class Workload {
+public:
+    std::string kind;
+    vtkSmartPointer<vtkPolyData> pdA, pdB;
+    int operMode;
+};
+
+// spheres, tori, holes, coplanar, sweep
+const std::vector<std::string>& GetWorkloadKinds ();
+
+Workload MakeWorkload (const std::string &kind, vtkIdType cells, unsigned int seed = 0);
+
+// die bausteine, alle aus dreiecken
+
+vtkSmartPointer<vtkPolyData> MakeSphere (vtkIdType cells, const double *center, double r);
+vtkSmartPointer<vtkPolyData> MakeTorus (vtkIdType cells, const double *center, double ringR, double crossR);
+vtkSmartPointer<vtkPolyData> MakeBox (vtkIdType cells, const double *bnds);
+
+// dreht um eine zufällige achse und verschiebt um höchstens shift in jede richtung
+void MoveRandomly (vtkPolyData *pd, std::mt19937 &gen, double shift);
+
+// std::uniform_real_distribution ist nicht auf allen plattformen gleich
+double Uniform (std::mt19937 &gen, double a, double b);
+
+// vtk oder stl, abhängig von der endung
+void WritePolyData (vtkPolyData *pd, const std::string &fileName);
+
+#endif
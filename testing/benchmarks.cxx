@@ -0,0 +1,543 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkCylinderSource.h>
+#include <vtkAppendPolyData.h>
+#include <vtkSTLReader.h>
+#include <vtkCommand.h>
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "vtkPolyDataBooleanFilter.h"
+#include "Workloads.h"
+
+#ifndef VTKBOOL_EXAMPLES
+#define VTKBOOL_EXAMPLES "examples/python/csg_model_making"
+#endif
+
+#ifdef VTKBOOL_PROFILE
+
+// mit VTKBOOL_PROFILE hat die bibliothek operator new bereits ersetzt
+
+std::size_t GetNumAllocs () { return GetAllocCounts().allocs; }
+std::size_t GetNumBytes () { return GetAllocCounts().bytes; }
+
+#else
+
+// zählt alle aufrufe von operator new, auch die aus vtk (außer unter windows, dort hat jede dll ihren eigenen)
+
+static std::atomic<std::size_t> numAllocs(0), numBytes(0);
+
+void* operator new (std::size_t size) {
+    numAllocs++;
+    numBytes += size;
+
+    void *p = std::malloc(size == 0 ? 1 : size);
+
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete (void *p) noexcept {
+    std::free(p);
+}
+
+std::size_t GetNumAllocs () { return numAllocs; }
+std::size_t GetNumBytes () { return numBytes; }
+
+#endif
+
+// setzt den spitzenwert des rss zurück, falls das system das erlaubt
+
+void ResetPeakRss () {
+#if defined(__linux__)
+    std::ofstream f("/proc/self/clear_refs");
+    f << "5";
+#endif
+}
+
+// in bytes
+
+std::size_t GetPeakRssSinceReset () {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+
+#if defined(__linux__)
+    std::ifstream f("/proc/self/status");
+    std::string line;
+
+    while (std::getline(f, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoul(line.substr(6))*1024;
+        }
+    }
+#endif
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss*1024;
+#endif
+
+#endif
+}
+
+class Bench {
+public:
+    std::string name;
+    // ungefähre anzahl der zellen beider eingaben
+    vtkIdType cells;
+    // mit reseed erzeugt make die eingaben für jede wiederholung neu, der seed ist die nummer der wiederholung
+    std::function<Workload (unsigned int seed)> make;
+    bool reseed;
+    double snap;
+
+    Bench (const std::string &name, vtkIdType cells, std::function<Workload (unsigned int)> make, bool reseed = false, double snap = 0) : name(name), cells(cells), make(make), reseed(reseed), snap(snap) {}
+};
+
+// zählt die fehler des filters
+
+class ErrorCounter : public vtkCommand {
+public:
+    int count;
+    std::string msg;
+
+    ErrorCounter () : count(0) {}
+
+    static ErrorCounter* New () {
+        return new ErrorCounter;
+    }
+
+    virtual void Execute (vtkObject *vtkNotUsed(caller), unsigned long vtkNotUsed(event), void *calldata) {
+        count++;
+        msg = static_cast<char*>(calldata);
+    }
+};
+
+Workload MakePair (vtkPolyData *pdA, vtkPolyData *pdB, int operMode) {
+    Workload w;
+    w.pdA = pdA;
+    w.pdB = pdB;
+    w.operMode = operMode;
+
+    return w;
+}
+
+class Result {
+public:
+    std::string name;
+    int reps, failures;
+    double realTime, cpuTime;
+    std::size_t peakRss, allocs, allocBytes;
+    vtkIdType cellsA, cellsB, cellsOut;
+    StatsType stats;
+    std::string error;
+
+    Result () : reps(0), failures(0), realTime(0), cpuTime(0), peakRss(0), allocs(0), allocBytes(0), cellsA(0), cellsB(0), cellsOut(0) {}
+};
+
+void AddBenchs (std::vector<Bench> &benchs, const std::string &data) {
+    // zwei kugeln mit jeweils n dreiecken
+
+    for (vtkIdType n : {1000, 10000, 100000, 1000000, 5000000}) {
+        benchs.emplace_back("SphereSphere/" + std::to_string(n), 2*n, [n] (unsigned int) {
+            double cA[] = {0, 0, 0}, cB[] = {.3, .2, .1};
+            return MakePair(MakeSphere(n, cA, .5), MakeSphere(n, cB, .5), OPER_UNION);
+        });
+    }
+
+    // würfel mit k*k durchgehenden bohrungen
+
+    for (int k : {2, 4, 8}) {
+        benchs.emplace_back("CubeWithHoles/" + std::to_string(k*k), 6+k*k*34, [k] (unsigned int) {
+            vtkSmartPointer<vtkCubeSource> cube = vtkSmartPointer<vtkCubeSource>::New();
+            cube->Update();
+
+            vtkSmartPointer<vtkAppendPolyData> app = vtkSmartPointer<vtkAppendPolyData>::New();
+
+            double d = 1./k;
+
+            for (int i = 0; i < k; i++) {
+                for (int j = 0; j < k; j++) {
+                    vtkSmartPointer<vtkCylinderSource> cyl = vtkSmartPointer<vtkCylinderSource>::New();
+                    cyl->SetRadius(d/3);
+                    cyl->SetHeight(2);
+                    cyl->SetResolution(32);
+                    cyl->SetCenter(-.5+d*(i+.5), 0, -.5+d*(j+.5));
+
+                    app->AddInputConnection(cyl->GetOutputPort());
+                }
+            }
+
+            app->Update();
+
+            return MakePair(cube->GetOutput(), app->GetOutput(), OPER_DIFFERENCE);
+        });
+    }
+
+    // zwei würfel mit koplanaren ober- und unterseiten
+
+    // jeweils auch mit SnapResolution, zum vergleich von laufzeit und fehlerrate
+
+    for (double snap : {0., 1e-6}) {
+        std::string suffix = snap > 0 ? "/snapped" : "";
+
+        for (int level : {0, 2, 4}) {
+            vtkIdType n = 12*(1 << 2*level);
+
+            benchs.emplace_back("CoplanarBoxes/" + std::to_string(level) + suffix, 2*n, [n] (unsigned int) {
+                double bndsA[] = {-.5, .5, -.5, .5, -.5, .5}, bndsB[] = {0, 1, -.5, .5, -.5, .5};
+                return MakePair(MakeBox(n, bndsA), MakeBox(n, bndsB), OPER_UNION);
+            }, false, snap);
+        }
+
+        // die fast koplanaren scheiben aus Workloads.h, jede wiederholung mit einem anderen seed
+
+        benchs.emplace_back("CoplanarBoxes/slabs" + suffix, 10000, [] (unsigned int seed) {
+            return MakeWorkload("coplanar", 10000, seed);
+        }, true, snap);
+    }
+
+    // die modelle aus den beispielen, jeweils abzüglich einer kugel im zentrum
+
+    for (const char *file : {"Schuerze1.stl", "Schuerze2.stl", "Schuerze3.stl", "Schuerze4.stl", "band.stl", "all.stl"}) {
+        std::string path = data + "/" + file;
+
+        benchs.emplace_back(std::string("Model/") + file, 0, [path] (unsigned int) {
+            vtkSmartPointer<vtkSTLReader> reader = vtkSmartPointer<vtkSTLReader>::New();
+            reader->SetFileName(path.c_str());
+            reader->Update();
+
+            vtkPolyData *pd = reader->GetOutput();
+
+            if (pd->GetNumberOfCells() == 0) {
+                throw std::runtime_error("cannot read " + path);
+            }
+
+            double bnds[6];
+            pd->GetBounds(bnds);
+
+            double r = std::sqrt(std::pow(bnds[1]-bnds[0], 2)+std::pow(bnds[3]-bnds[2], 2)+std::pow(bnds[5]-bnds[4], 2))/8;
+
+            double c[] = {(bnds[0]+bnds[1])/2, (bnds[2]+bnds[3])/2, (bnds[4]+bnds[5])/2};
+
+            return MakePair(pd, MakeSphere(4608, c, r), OPER_DIFFERENCE);
+        });
+    }
+
+    // die workloads aus Workloads.h von 10^3 bis 10^7 zellen
+
+    for (auto &kind : GetWorkloadKinds()) {
+        for (vtkIdType n = 1000; n <= 10000000; n *= 10) {
+            benchs.emplace_back("Scaling/" + kind + "/" + std::to_string(n), n, [kind, n] (unsigned int) {
+                return MakeWorkload(kind, n);
+            });
+        }
+    }
+}
+
+Result Run (const Bench &bench, int reps) {
+    Result res;
+    res.name = bench.name;
+
+    Workload inputs;
+
+    std::string errMsg;
+
+    for (int i = 0; i < reps; i++) {
+        if (i == 0 || bench.reseed) {
+            try {
+                inputs = bench.make(i);
+            } catch (const std::exception &e) {
+                res.error = e.what();
+                return res;
+            }
+
+            res.cellsA = inputs.pdA->GetNumberOfCells();
+            res.cellsB = inputs.pdB->GetNumberOfCells();
+        }
+
+        vtkSmartPointer<vtkPolyDataBooleanFilter> bf = vtkSmartPointer<vtkPolyDataBooleanFilter>::New();
+        bf->SetInputData(0, inputs.pdA);
+        bf->SetInputData(1, inputs.pdB);
+        bf->SetOperMode(inputs.operMode);
+        bf->SetSnapResolution(bench.snap);
+
+        vtkSmartPointer<ErrorCounter> errs = vtkSmartPointer<ErrorCounter>::New();
+        bf->AddObserver(vtkCommand::ErrorEvent, errs);
+
+        ResetPeakRss();
+
+        std::size_t allocs = GetNumAllocs(), bytes = GetNumBytes();
+
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+
+        bf->Update();
+
+        res.realTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+        res.cpuTime += 1000.*(std::clock()-cpuStart)/CLOCKS_PER_SEC;
+
+        res.allocs += GetNumAllocs()-allocs;
+        res.allocBytes += GetNumBytes()-bytes;
+
+        res.peakRss = std::max(res.peakRss, GetPeakRssSinceReset());
+
+        for (auto &s : bf->GetStats()) {
+            res.stats[s.first] += s.second;
+        }
+
+        res.cellsOut = bf->GetOutput()->GetNumberOfCells();
+
+        // ein fehler wie "Strips are invalid." lässt den durchlauf scheitern
+
+        if (errs->count > 0) {
+            res.failures++;
+            errMsg = errs->msg;
+        } else if (res.cellsOut == 0) {
+            res.failures++;
+            errMsg = "empty result";
+        }
+    }
+
+    // erst wenn alle wiederholungen scheitern, gilt der benchmark als fehlgeschlagen
+
+    if (res.failures == reps) {
+        res.error = errMsg;
+    }
+
+    res.reps = reps;
+
+    res.realTime /= reps;
+    res.cpuTime /= reps;
+    res.allocs /= reps;
+    res.allocBytes /= reps;
+
+    for (auto &s : res.stats) {
+        s.second /= reps;
+    }
+
+    return res;
+}
+
+std::string Escape (const std::string &s) {
+    std::string r;
+
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+        }
+        r += c;
+    }
+
+    return r;
+}
+
+// im format von google benchmark, zusätzliche werte sind zähler auf der obersten ebene
+
+void WriteJson (std::ostream &out, const std::vector<Result> &results, const char *exe) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << std::setprecision(9);
+
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"" << Escape(exe) << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n"
+        << "  \"benchmarks\": [";
+
+    for (auto itr = results.begin(); itr != results.end(); ++itr) {
+        const Result &r = *itr;
+
+        out << (itr == results.begin() ? "\n" : ",\n")
+            << "    {\n"
+            << "      \"name\": \"" << Escape(r.name) << "\",\n"
+            << "      \"run_name\": \"" << Escape(r.name) << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"repetitions\": " << r.reps << ",\n"
+            << "      \"iterations\": 1,\n";
+
+        if (!r.error.empty()) {
+            out << "      \"error_occurred\": true,\n"
+                << "      \"error_message\": \"" << Escape(r.error) << "\",\n";
+        }
+
+        out << "      \"real_time\": " << r.realTime << ",\n"
+            << "      \"cpu_time\": " << r.cpuTime << ",\n"
+            << "      \"time_unit\": \"ms\",\n"
+            << "      \"cells_a\": " << r.cellsA << ",\n"
+            << "      \"cells_b\": " << r.cellsB << ",\n"
+            << "      \"cells_out\": " << r.cellsOut << ",\n"
+            << "      \"peak_rss\": " << r.peakRss << ",\n"
+            << "      \"failures\": " << r.failures << ",\n"
+            << "      \"failure_rate\": " << (r.reps > 0 ? static_cast<double>(r.failures)/r.reps : 0.) << ",\n"
+            << "      \"allocs\": " << r.allocs << ",\n"
+            << "      \"alloc_bytes\": " << r.allocBytes;
+
+        for (auto &s : r.stats) {
+            out << ",\n      \"" << Escape(s.first) << "\": " << s.second;
+        }
+
+        out << "\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+void Usage (const char *exe) {
+    std::cout << "usage: " << exe << " [options]\n"
+        << "  --filter=<str>       runs only benchmarks whose name contains str\n"
+        << "  --repetitions=<n>    runs each benchmark n times (default 3)\n"
+        << "  --max-cells=<n>      skips benchmarks with more input cells (default 1000000)\n"
+        << "  --data=<dir>         directory with the stl files (default " << VTKBOOL_EXAMPLES << ")\n"
+        << "  --out=<file>         writes the results as json\n"
+        << "  --list               lists the benchmarks\n";
+}
+
+int main (int argc, char *argv[]) {
+    std::string filter, out, data = VTKBOOL_EXAMPLES;
+    int reps = 3;
+    vtkIdType maxCells = 1000000;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+
+        auto Val = [&arg] () { return arg.substr(arg.find('=')+1); };
+
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = Val();
+        } else if (arg.compare(0, 14, "--repetitions=") == 0) {
+            reps = std::max(1, std::stoi(Val()));
+        } else if (arg.compare(0, 12, "--max-cells=") == 0) {
+            maxCells = std::stoll(Val());
+        } else if (arg.compare(0, 7, "--data=") == 0) {
+            data = Val();
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            out = Val();
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            Usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<Bench> benchs;
+    AddBenchs(benchs, data);
+
+    std::vector<Result> results;
+
+    bool failed = false;
+
+    for (auto &bench : benchs) {
+        if (bench.name.find(filter) == std::string::npos
+            || bench.cells > maxCells) {
+            continue;
+        }
+
+        if (list) {
+            std::cout << bench.name << std::endl;
+            continue;
+        }
+
+        Result res = Run(bench, reps);
+
+        std::cout << std::left << std::setw(28) << res.name << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << res.realTime << " ms"
+            << std::setw(10) << res.peakRss/1048576. << " MiB"
+            << std::setw(12) << res.allocs << " allocs";
+
+        if (res.failures > 0) {
+            std::cout << std::setw(6) << res.failures << "/" << res.reps << " failed";
+        }
+
+        if (!res.error.empty()) {
+            std::cout << "  ERROR: " << res.error;
+            failed = true;
+        }
+
+        std::cout << std::endl;
+
+        for (auto &s : res.stats) {
+            if (s.first.compare(0, 4, "time") == 0) {
+                std::cout << "    " << std::left << std::setw(24) << s.first.substr(4) << std::right
+                    << std::setw(12) << s.second*1000 << " ms" << std::endl;
+            }
+        }
+
+        results.push_back(res);
+    }
+
+    if (!out.empty()) {
+        std::ofstream f(out);
+
+        if (!f) {
+            std::cerr << "cannot write " << out << std::endl;
+            return 1;
+        }
+
+        WriteJson(f, results, argv[0]);
+    }
+
+    return failed ? 1 : 0;
+}
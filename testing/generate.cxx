@@ -0,0 +1,103 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+#include "Workloads.h"
+
+// schreibt die eingaben eines workloads als <prefix>_<seed>_A.<format> und <prefix>_<seed>_B.<format>
+
+void Usage (const char *exe) {
+    std::cout << "usage: " << exe << " <kind> [options]\n"
+        << "  kinds:";
+
+    for (auto &kind : GetWorkloadKinds()) {
+        std::cout << " " << kind;
+    }
+
+    std::cout << "\n"
+        << "  --cells=<n>      cells of both inputs together (default 10000)\n"
+        << "  --seed=<n>       first seed (default 0)\n"
+        << "  --count=<n>      number of consecutive seeds (default 1)\n"
+        << "  --format=vtk|stl (default vtk)\n"
+        << "  --prefix=<str>   (default <kind>_<cells>)\n";
+}
+
+int main (int argc, char *argv[]) {
+    if (argc < 2) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    std::string kind(argv[1]), format = "vtk", prefix;
+
+    vtkIdType cells = 10000;
+    unsigned int seed = 0;
+    int count = 1;
+
+    if (std::find(GetWorkloadKinds().begin(), GetWorkloadKinds().end(), kind) == GetWorkloadKinds().end()) {
+        Usage(argv[0]);
+        return kind == "--help" ? 0 : 1;
+    }
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg(argv[i]);
+
+        auto Val = [&arg] () { return arg.substr(arg.find('=')+1); };
+
+        if (arg.compare(0, 8, "--cells=") == 0) {
+            cells = std::stoll(Val());
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            seed = std::stoul(Val());
+        } else if (arg.compare(0, 8, "--count=") == 0) {
+            count = std::stoi(Val());
+        } else if (arg.compare(0, 9, "--format=") == 0) {
+            format = Val();
+        } else if (arg.compare(0, 9, "--prefix=") == 0) {
+            prefix = Val();
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (format != "vtk" && format != "stl") {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    if (prefix.empty()) {
+        prefix = kind + "_" + std::to_string(cells);
+    }
+
+    for (int i = 0; i < count; i++) {
+        Workload w = MakeWorkload(kind, cells, seed+i);
+
+        std::string name = prefix + "_" + std::to_string(seed+i);
+
+        WritePolyData(w.pdA, name + "_A." + format);
+        WritePolyData(w.pdB, name + "_B." + format);
+
+        std::cout << name << ": "
+            << w.pdA->GetNumberOfCells() << " + "
+            << w.pdB->GetNumberOfCells() << " cells, oper mode "
+            << w.operMode << std::endl;
+    }
+
+    return 0;
+}
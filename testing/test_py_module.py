@@ -28,3 +28,103 @@ import vtkboolPython
 vtkboolPython.vtkPolyDataBooleanFilter()
 
 #import vtk
+
+# vtkboolNumPy, nur wenn numpy vorhanden ist
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+if np is not None:
+    import vtkboolNumPy
+
+    def cube(o):
+        pts = np.array([[x, y, z] for z in (0, 1) for y in (0, 1) for x in (0, 1)], dtype=np.float64)+o
+
+        polys = np.array([[0, 2, 3, 1], [4, 5, 7, 6],
+            [0, 1, 5, 4], [2, 6, 7, 3],
+            [0, 4, 6, 2], [1, 3, 7, 5]], dtype=np.int64)
+
+        return pts, polys
+
+    ptsA, polysA = cube(0)
+    ptsB, polysB = cube(.5)
+
+    res = vtkboolNumPy.boolean(ptsA, polysA, ptsB, polysB, oper_mode=0)
+
+    offs = np.asarray(res['offsets'])
+    conn = np.asarray(res['connectivity'])
+    pts = np.asarray(res['points'])
+
+    assert len(offs) > 1 and offs[-1] == len(conn)
+    assert pts.shape[1] == 3 and conn.max() < len(pts)
+
+    assert np.asarray(res['OrigCellIdsA']).max() < len(polysA)
+    assert np.asarray(res['OrigCellIdsB']).max() < len(polysB)
+
+    # als (offsets, connectivity) mit int32
+
+    res2 = vtkboolNumPy.boolean(ptsA, (np.arange(0, 25, 4, dtype=np.int32), polysA.astype(np.int32).ravel()),
+        ptsB, polysB, oper_mode=0)
+
+    assert len(res2['offsets']) == len(offs)
+
+    try:
+        vtkboolNumPy.boolean(ptsA, polysA+8, ptsB, polysB)
+        assert False
+    except ValueError:
+        pass
+
+    # boolean gibt den gil frei, unabhängige aufrufe laufen in threads parallel
+
+    import time
+    import os
+    from concurrent.futures import ThreadPoolExecutor
+
+    def sphere(c, res=64):
+        t = np.linspace(0, np.pi, res+1)[1:-1]
+        p = np.linspace(0, 2*np.pi, res, endpoint=False)
+
+        tt, pp = np.meshgrid(t, p, indexing='ij')
+
+        pts = np.vstack([[0, 0, 1],
+            np.column_stack([np.sin(tt.ravel())*np.cos(pp.ravel()), np.sin(tt.ravel())*np.sin(pp.ravel()), np.cos(tt.ravel())]),
+            [0, 0, -1]])+c
+
+        ring = lambda i, j: 1+i*res+j%res
+
+        polys = []
+
+        for j in range(res):
+            polys.append([0, ring(0, j), ring(0, j+1)])
+            polys.append([len(pts)-1, ring(res-2, j+1), ring(res-2, j)])
+
+        quads = [[ring(i, j), ring(i+1, j), ring(i+1, j+1), ring(i, j+1)] for i in range(res-2) for j in range(res)]
+
+        return pts, (np.cumsum([0]+[len(p) for p in polys+quads]), np.concatenate(polys+quads).astype(np.int64))
+
+    jobs = [sphere(0)+sphere([.3+i*.01, .2, .1]) for i in range(16)]
+
+    def run(job):
+        return len(vtkboolNumPy.boolean(*job, oper_mode=2)['offsets'])
+
+    def throughput(workers):
+        with ThreadPoolExecutor(workers) as ex:
+            start = time.time()
+            res = list(ex.map(run, jobs))
+            return res, len(jobs)/(time.time()-start)
+
+    res1, t1 = throughput(1)
+
+    workers = min(4, os.cpu_count() or 1)
+
+    resN, tN = throughput(workers)
+
+    assert res1 == resN
+
+    print('%d threads: %.2fx the throughput of one thread' % (workers, tN/t1))
+
+    # die zeiten schwanken auf geteilten rechnern, daher nur auf verlangen
+    if workers > 1 and os.environ.get('VTKBOOL_CHECK_SCALING'):
+        assert tN/t1 > 1.25
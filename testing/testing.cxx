@@ -34,6 +34,8 @@ limitations under the License.
 #include <vtkTubeFilter.h>
 #include <vtkCommand.h>
 #include <vtkPolyDataConnectivityFilter.h>
+#include <vtkPolygon.h>
+#include <vtkDirectory.h>
 
 #include <map>
 #include <vector>
@@ -44,6 +46,7 @@ limitations under the License.
 #include <iomanip>
 #include <cmath>
 #include <array>
+#include <thread>
 
 #include "vtkPolyDataBooleanFilter.h"
 
@@ -51,8 +54,6 @@ limitations under the License.
 
 // #define DD
 
-int Point::_tag = 0;
-
 typedef std::map<int, IdsType> LinksType;
 
 class Test {
@@ -371,6 +372,28 @@ public:
     }
 };
 
+class ProgressObserver : public vtkCommand {
+public:
+    std::vector<double> progs;
+    double abortAt;
+
+    ProgressObserver() : abortAt(2) {}
+
+    static ProgressObserver *New() {
+        return new ProgressObserver;
+    }
+
+    virtual void Execute(vtkObject *caller, unsigned long vtkNotUsed(event), void *calldata) {
+        double p = *static_cast<double*>(calldata);
+
+        progs.push_back(p);
+
+        if (p >= abortAt) {
+            vtkAlgorithm::SafeDownCast(caller)->SetAbortExecute(1);
+        }
+    }
+};
+
 int main (int vtkNotUsed(argc), char *argv[]) {
     std::istringstream stream(argv[1]);
     int t;
@@ -1280,6 +1303,478 @@ int main (int vtkNotUsed(argc), char *argv[]) {
 
         return ok;
 
+    } else if (t == 21) {
+        // nahezu koplanare flächen, die erst durch das einrasten koplanar werden
+
+        vtkCubeSource *cuA = vtkCubeSource::New();
+
+        vtkCubeSource *cuB = vtkCubeSource::New();
+        cuB->SetCenter(.5, .5, 1e-5);
+
+        Observer *obs = Observer::New();
+
+        vtkPolyDataBooleanFilter *bf = vtkPolyDataBooleanFilter::New();
+        bf->SetInputConnection(0, cuA->GetOutputPort());
+        bf->SetInputConnection(1, cuB->GetOutputPort());
+        bf->SetSnapResolution(1e-4);
+        bf->MergeRegsOn();
+        bf->AddObserver(vtkCommand::ErrorEvent, obs);
+
+        bf->Update();
+
+        int ok = obs->hasError;
+
+        vtkPolyData *res = bf->GetOutput(0);
+
+        // alle punkte liegen auf dem gitter, die deckflächen also exakt auf z = 0.5
+
+        for (vtkIdType i = 0; i < res->GetNumberOfPoints() && !ok; i++) {
+            double z = res->GetPoint(i)[2]/1e-4;
+
+            if (std::abs(z-std::round(z)) > 1e-6) {
+                std::cout << "point " << i << " is not snapped" << std::endl;
+                ok = 1;
+            }
+        }
+
+        // ohne einrasten entstünden seitenflächen mit einer höhe von 1e-5 zwischen den deckflächen
+
+        double bnds[6];
+
+        for (vtkIdType i = 0; i < res->GetNumberOfCells() && !ok; i++) {
+            res->GetCellBounds(i, bnds);
+
+            if (bnds[5]-bnds[4] > 0 && bnds[5]-bnds[4] < 1e-4) {
+                std::cout << "cell " << i << " is a sliver" << std::endl;
+                ok = 1;
+            }
+        }
+
+        if (!ok) {
+            Test test(res, bf->GetOutput(1));
+            ok = test.run();
+        }
+
+        bf->Delete();
+        obs->Delete();
+        cuB->Delete();
+        cuA->Delete();
+
+        return ok;
+
+    } else if (t == 22) {
+        // vergleicht die beiden zerlegungen an einem loch mit vielen punkten
+
+        vtkCubeSource *cu = vtkCubeSource::New();
+
+        vtkCylinderSource *cyl = vtkCylinderSource::New();
+        cyl->SetResolution(128);
+        cyl->SetRadius(.4);
+        cyl->SetHeight(2);
+
+        Observer *obs = Observer::New();
+
+        vtkPolyDataBooleanFilter *bf = vtkPolyDataBooleanFilter::New();
+        bf->SetInputConnection(0, cu->GetOutputPort());
+        bf->SetInputConnection(1, cyl->GetOutputPort());
+        bf->SetOperModeToDifference();
+        bf->AddObserver(vtkCommand::ErrorEvent, obs);
+
+        vtkIdList *cell = vtkIdList::New();
+
+        std::vector<vtkIdType> nums;
+        std::vector<double> areas;
+
+        int ok = 0;
+
+        for (int mode : {DEC_MINIMAL, DEC_FAST}) {
+            bf->SetDecMode(mode);
+            bf->Update();
+
+            ok |= static_cast<int>(obs->hasError);
+
+            vtkPolyData *pd = bf->GetOutput(0);
+
+            vtkIdType i, j, numCells = pd->GetNumberOfCells();
+
+            double area = 0, n[3], a[3], b[3], c[3], e[3], f[3], x[3];
+
+            for (i = 0; i < numCells; i++) {
+                pd->GetCellPoints(i, cell);
+
+                vtkIdType numPts = cell->GetNumberOfIds();
+
+                area += vtkPolygon::ComputeArea(pd->GetPoints(), numPts, cell->GetPointer(0), n);
+
+                if (mode != DEC_FAST) {
+                    continue;
+                }
+
+                // jede ecke muss konvex sein, kollineare ecken sind erlaubt
+
+                for (j = 0; j < numPts; j++) {
+                    pd->GetPoint(cell->GetId(j), a);
+                    pd->GetPoint(cell->GetId((j+1)%numPts), b);
+                    pd->GetPoint(cell->GetId((j+2)%numPts), c);
+
+                    vtkMath::Subtract(b, a, e);
+                    vtkMath::Subtract(c, b, f);
+                    vtkMath::Cross(e, f, x);
+
+                    if (vtkMath::Dot(x, n) < -1e-10) {
+                        std::cout << "cell " << i << " is not convex" << std::endl;
+                        ok = 1;
+                        break;
+                    }
+                }
+            }
+
+            nums.push_back(numCells);
+            areas.push_back(area);
+        }
+
+        std::cout << "cells " << nums[0] << ", " << nums[1]
+            << ", area " << areas[0] << ", " << areas[1] << std::endl;
+
+        // die anzahl der polygone kann in beide richtungen abweichen, die fläche muss gleich sein
+        if (std::abs(areas[1]-areas[0]) > 1e-6) {
+            ok = 1;
+        }
+
+        cell->Delete();
+        bf->Delete();
+        obs->Delete();
+        cyl->Delete();
+        cu->Delete();
+
+        return ok;
+
+    } else if (t == 23) {
+        // bricht in der mitte ab und rechnet danach vollständig
+
+        vtkSphereSource *spA = vtkSphereSource::New();
+        spA->SetThetaResolution(64);
+        spA->SetPhiResolution(64);
+
+        vtkSphereSource *spB = vtkSphereSource::New();
+        spB->SetThetaResolution(64);
+        spB->SetPhiResolution(64);
+        spB->SetCenter(.3, .2, .1);
+
+        ProgressObserver *obs = ProgressObserver::New();
+        obs->abortAt = .4;
+
+        vtkPolyDataBooleanFilter *bf = vtkPolyDataBooleanFilter::New();
+        bf->SetInputConnection(0, spA->GetOutputPort());
+        bf->SetInputConnection(1, spB->GetOutputPort());
+        bf->MergeRegsOn();
+        bf->AddObserver(vtkCommand::ProgressEvent, obs);
+
+        bf->Update();
+
+        int ok = 0;
+
+        if (bf->GetOutput(0)->GetNumberOfCells() != 0) {
+            std::cout << "output after abort" << std::endl;
+            ok = 1;
+        }
+
+        obs->abortAt = 2;
+        obs->progs.clear();
+
+        bf->Modified();
+        bf->Update();
+
+        if (!std::is_sorted(obs->progs.begin(), obs->progs.end()) || obs->progs.empty() || obs->progs.back() != 1) {
+            std::cout << "progress not monotonic" << std::endl;
+            ok = 1;
+        }
+
+        if (ok == 0) {
+            Test test(bf->GetOutput(0), bf->GetOutput(1));
+            ok = test.run();
+        }
+
+        bf->Delete();
+        obs->Delete();
+        spB->Delete();
+        spA->Delete();
+
+        return ok;
+
+    } else if (t == 24) {
+        // mehrere instanzen gleichzeitig, jede mit eigenen eingaben
+
+        auto Run = [](double off, std::array<vtkIdType, 3> &res) {
+            vtkSphereSource *spA = vtkSphereSource::New();
+            spA->SetThetaResolution(48);
+            spA->SetPhiResolution(48);
+
+            vtkSphereSource *spB = vtkSphereSource::New();
+            spB->SetThetaResolution(48);
+            spB->SetPhiResolution(48);
+            spB->SetCenter(off, .2, .1);
+
+            vtkPolyDataBooleanFilter *bf = vtkPolyDataBooleanFilter::New();
+            bf->SetInputConnection(0, spA->GetOutputPort());
+            bf->SetInputConnection(1, spB->GetOutputPort());
+            bf->SetOperModeToDifference();
+
+            bf->Update();
+
+            res = {bf->GetOutput(0)->GetNumberOfCells(), bf->GetOutput(0)->GetNumberOfPoints(), bf->GetOutput(1)->GetNumberOfCells()};
+
+            bf->Delete();
+            spB->Delete();
+            spA->Delete();
+        };
+
+        const int num = 8;
+
+        std::vector<std::array<vtkIdType, 3>> seq(num), par(num);
+
+        for (int i = 0; i < num; i++) {
+            Run(.2+i*.05, seq[i]);
+        }
+
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < num; i++) {
+            threads.emplace_back(Run, .2+i*.05, std::ref(par[i]));
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        if (seq != par) {
+            std::cout << "concurrent results differ" << std::endl;
+            return 1;
+        }
+
+        return 0;
+
+    } else if (t == 25) {
+        // die zweite instanz liest den zustand vor der zerlegung aus der datei der ersten
+
+        // ein eigenes verzeichnis, damit kein abbild eines früheren laufs gelesen wird
+        const char *dir = "snapshots_25";
+
+        vtkDirectory::DeleteDirectory(dir);
+        vtkDirectory::MakeDirectory(dir);
+
+        vtkSphereSource *spA = vtkSphereSource::New();
+        spA->SetThetaResolution(32);
+        spA->SetPhiResolution(32);
+
+        vtkSphereSource *spB = vtkSphereSource::New();
+        spB->SetThetaResolution(32);
+        spB->SetPhiResolution(32);
+        spB->SetCenter(.3, .2, .1);
+
+        vtkPolyDataBooleanFilter *bfA = vtkPolyDataBooleanFilter::New();
+        bfA->SetInputConnection(0, spA->GetOutputPort());
+        bfA->SetInputConnection(1, spB->GetOutputPort());
+        bfA->SetSnapshotDir(dir);
+
+        bfA->Update();
+
+        vtkPolyDataBooleanFilter *bfB = vtkPolyDataBooleanFilter::New();
+        bfB->SetInputConnection(0, spA->GetOutputPort());
+        bfB->SetInputConnection(1, spB->GetOutputPort());
+        bfB->SetOperModeToDifference();
+        bfB->SetSnapshotDir(dir);
+
+        bfB->Update();
+
+        vtkPolyDataBooleanFilter *bfC = vtkPolyDataBooleanFilter::New();
+        bfC->SetInputConnection(0, spA->GetOutputPort());
+        bfC->SetInputConnection(1, spB->GetOutputPort());
+        bfC->SetOperModeToDifference();
+
+        bfC->Update();
+
+        int ok = 0;
+
+        if (bfA->GetStats().count("timeSave") == 0) {
+            std::cout << "snapshot not written" << std::endl;
+            ok = 1;
+        }
+
+        if (bfB->GetStats().count("timeContact") == 1) {
+            std::cout << "snapshot not used" << std::endl;
+            ok = 1;
+        }
+
+        vtkPolyData *resB = bfB->GetOutput(0),
+            *resC = bfC->GetOutput(0);
+
+        if (resB->GetNumberOfCells() != resC->GetNumberOfCells() || resB->GetNumberOfPoints() != resC->GetNumberOfPoints()) {
+            std::cout << "results differ" << std::endl;
+            ok = 1;
+        }
+
+        if (ok == 0) {
+            Test test(resB, bfB->GetOutput(1));
+            ok = test.run();
+        }
+
+        bfC->Delete();
+        bfB->Delete();
+        bfA->Delete();
+        spB->Delete();
+        spA->Delete();
+
+        vtkDirectory::DeleteDirectory(dir);
+
+        return ok;
+
+    } else if (t == 26) {
+        // mit MergeRegs stammt jede zelle aus genau einer eingabe
+
+        vtkSphereSource *spA = vtkSphereSource::New();
+
+        vtkSphereSource *spB = vtkSphereSource::New();
+        spB->SetCenter(.3, .2, .1);
+
+        vtkPolyDataBooleanFilter *bf = vtkPolyDataBooleanFilter::New();
+        bf->SetInputConnection(0, spA->GetOutputPort());
+        bf->SetInputConnection(1, spB->GetOutputPort());
+        bf->MergeRegsOn();
+
+        bf->Update();
+
+        vtkPolyData *res = bf->GetOutput(0);
+
+        vtkIntArray *origCellIdsA = vtkIntArray::SafeDownCast(res->GetCellData()->GetArray("OrigCellIdsA"));
+        vtkIntArray *origCellIdsB = vtkIntArray::SafeDownCast(res->GetCellData()->GetArray("OrigCellIdsB"));
+
+        int ok = 0;
+
+        if (origCellIdsA == nullptr || origCellIdsB == nullptr || res->GetCellData()->GetArray("OrigCellIds") != nullptr) {
+            std::cout << "wrong arrays" << std::endl;
+            ok = 1;
+        } else {
+            int numA = 0, numB = 0;
+
+            for (vtkIdType i = 0; i < res->GetNumberOfCells(); i++) {
+                int idA = origCellIdsA->GetValue(i),
+                    idB = origCellIdsB->GetValue(i);
+
+                if ((idA > -1) == (idB > -1)) {
+                    std::cout << "cell " << i << " has the ids " << idA << " and " << idB << std::endl;
+                    ok = 1;
+                    break;
+                }
+
+                idA > -1 ? numA++ : numB++;
+            }
+
+            if (numA == 0 || numB == 0) {
+                std::cout << "one input is missing" << std::endl;
+                ok = 1;
+            }
+        }
+
+        bf->Delete();
+        spB->Delete();
+        spA->Delete();
+
+        return ok;
+
+    } else if (t == 27) {
+        // der gekachelte modus liefert dieselbe fläche wie der normale
+
+        vtkSphereSource *spA = vtkSphereSource::New();
+        spA->SetThetaResolution(48);
+        spA->SetPhiResolution(48);
+
+        vtkSphereSource *spB = vtkSphereSource::New();
+        spB->SetThetaResolution(48);
+        spB->SetPhiResolution(48);
+        spB->SetCenter(.3, .2, .1);
+
+        auto Area = [] (vtkPolyData *pd) {
+            double area = 0, n[3];
+
+            vtkIdType num, *poly;
+
+            for (vtkIdType i = 0; i < pd->GetNumberOfCells(); i++) {
+                pd->GetCellPoints(i, num, poly);
+                area += vtkPolygon::ComputeArea(pd->GetPoints(), num, poly, n);
+            }
+
+            return area;
+        };
+
+        int ok = 0;
+
+        for (int mode : {OPER_UNION, OPER_DIFFERENCE}) {
+            vtkPolyDataBooleanFilter *bf = vtkPolyDataBooleanFilter::New();
+            bf->SetInputConnection(0, spA->GetOutputPort());
+            bf->SetInputConnection(1, spB->GetOutputPort());
+
+            if (mode == OPER_DIFFERENCE) {
+                bf->SetOperModeToDifference();
+            }
+
+            bf->Update();
+
+            double area = Area(bf->GetOutput(0));
+
+            for (double size : {.25, .5}) {
+                Observer *obs = Observer::New();
+
+                vtkPolyDataBooleanFilter *tiled = vtkPolyDataBooleanFilter::New();
+                tiled->SetInputConnection(0, spA->GetOutputPort());
+                tiled->SetInputConnection(1, spB->GetOutputPort());
+                tiled->SetTileSize(size);
+                tiled->AddObserver(vtkCommand::ErrorEvent, obs);
+
+                if (mode == OPER_DIFFERENCE) {
+                    tiled->SetOperModeToDifference();
+                }
+
+                tiled->Update();
+
+                vtkPolyData *res = tiled->GetOutput(0);
+
+                double _area = Area(res);
+
+                if (obs->hasError) {
+                    std::cout << "error with tile size " << size << ": " << obs->msg << std::endl;
+                    ok = 1;
+                } else if (tiled->GetStats().at("numTiles") < 2) {
+                    std::cout << "not tiled" << std::endl;
+                    ok = 1;
+                } else if (std::abs(_area-area) > 1e-6*area) {
+                    std::cout << "area " << _area << " differs from " << area << " with tile size " << size << std::endl;
+                    ok = 1;
+                } else {
+                    Test test(res, tiled->GetOutput(1));
+                    ok = test.run();
+                }
+
+                tiled->Delete();
+                obs->Delete();
+
+                if (ok != 0) {
+                    break;
+                }
+            }
+
+            bf->Delete();
+
+            if (ok != 0) {
+                break;
+            }
+        }
+
+        spB->Delete();
+        spA->Delete();
+
+        return ok;
+
     }
 
 }
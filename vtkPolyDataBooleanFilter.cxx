@@ -22,6 +22,9 @@ limitations under the License.
 #include <cmath>
 #include <functional>
 #include <queue>
+#include <atomic>
+#include <mutex>
+#include <cstdio>
 
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
@@ -38,19 +41,22 @@ limitations under the License.
 #include <vtkCleanPolyData.h>
 #include <vtkPolyDataConnectivityFilter.h>
 #include <vtkSmartPointer.h>
+#include <vtkSMPTools.h>
+#include <vtkCommand.h>
 
 #include "vtkPolyDataBooleanFilter.h"
 #include "vtkPolyDataContactFilter.h"
 
 #include "Utilities.h"
+#include "Snapshot.h"
 
 #include "Merger.h"
 #include "Decomposer.h"
+#include "HmDecomposer.h"
 #include "AABB.h"
 
 // #ifdef DEBUG
 #include <chrono>
-#include <numeric>
 #include <iterator>
 // #endif
 
@@ -64,6 +70,9 @@ vtkPolyDataBooleanFilter::vtkPolyDataBooleanFilter () {
     timePdA = 0;
     timePdB = 0;
 
+    numCellsA = 0;
+    numCellsB = 0;
+
     contLines = vtkPolyData::New();
 
     modPdA = vtkPolyData::New();
@@ -79,11 +88,27 @@ vtkPolyDataBooleanFilter::vtkPolyDataBooleanFilter () {
 
     MergeRegs = false;
     DecPolys = true;
+    DecMode = DEC_MINIMAL;
+
+    SnapResolution = 0;
+
+    TileSize = 0;
+
+    progStart = 0;
+    progEnd = 1;
+    progCount = 0;
+
+    progOffset = 0;
+    progScale = 1;
+
+    SnapshotDir = nullptr;
 
 }
 
 vtkPolyDataBooleanFilter::~vtkPolyDataBooleanFilter () {
 
+    SetSnapshotDir(nullptr);
+
     cellIdsA->Delete();
     cellIdsB->Delete();
 
@@ -113,11 +138,33 @@ int vtkPolyDataBooleanFilter::ProcessRequest(vtkInformation *request, vtkInforma
         resultA = vtkPolyData::SafeDownCast(outInfoA->Get(vtkDataObject::DATA_OBJECT()));
         resultB = vtkPolyData::SafeDownCast(outInfoB->Get(vtkDataObject::DATA_OBJECT()));
 
-// #ifdef DEBUG
-        using clock = std::chrono::steady_clock;
-        std::vector<clock::duration> times;
-        clock::time_point start;
-// #endif
+        std::string snapFile;
+        std::uint64_t snapHash = 0;
+
+        if (pdA->GetMTime() > timePdA || pdB->GetMTime() > timePdB) {
+
+            stats.clear();
+
+#ifdef VTKBOOL_PROFILE
+            stats["rssStart"] = GetCurrentRss();
+#endif
+
+            if (SnapshotDir != nullptr && *SnapshotDir != '\0' && TileSize <= 0) {
+                snapFile = GetSnapshotFile(pdA, pdB, snapHash);
+
+                StageTimer timer(stats, "Load");
+
+                if (LoadSnapshot(snapFile, snapHash)) {
+                    // es geht direkt mit der zerlegung weiter
+                    relsA.clear();
+                    relsB.clear();
+
+                    timePdA = pdA->GetMTime();
+                    timePdB = pdB->GetMTime();
+                }
+            }
+
+        }
 
         if (pdA->GetMTime() > timePdA || pdB->GetMTime() > timePdB) {
 
@@ -127,325 +174,854 @@ int vtkPolyDataBooleanFilter::ProcessRequest(vtkInformation *request, vtkInforma
             cleanA->SetOutputPointsPrecision(DOUBLE_PRECISION);
             cleanA->SetTolerance(1e-6);
             cleanA->SetInputData(pdA);
-            cleanA->Update();
 
             vtkSmartPointer<vtkCleanPolyData> cleanB = vtkSmartPointer<vtkCleanPolyData>::New();
             cleanB->SetOutputPointsPrecision(DOUBLE_PRECISION);
             cleanB->SetTolerance(1e-6);
             cleanB->SetInputData(pdB);
-            cleanB->Update();
+
+            SetProgressRange(0, .05);
+
+            {
+                StageTimer timer(stats, "Clean");
+
+                cleanA->Update();
+                cleanB->Update();
+            }
+
+            vtkPolyData *inA = cleanA->GetOutput(),
+                *inB = cleanB->GetOutput();
+
+            vtkSmartPointer<vtkCleanPolyData> snapA = vtkSmartPointer<vtkCleanPolyData>::New();
+            vtkSmartPointer<vtkCleanPolyData> snapB = vtkSmartPointer<vtkCleanPolyData>::New();
+
+            if (SnapResolution > 0) {
+                // nahezu gleiche punkte und nahezu koplanare flächen werden exakt gleich
+
+                SnapPoints(inA, SnapResolution);
+                SnapPoints(inB, SnapResolution);
+
+                // zusammengefallene punkte vereinen
+
+                snapA->SetOutputPointsPrecision(DOUBLE_PRECISION);
+                snapA->SetTolerance(0);
+                snapA->SetInputData(inA);
+                snapA->Update();
+
+                snapB->SetOutputPointsPrecision(DOUBLE_PRECISION);
+                snapB->SetTolerance(0);
+                snapB->SetInputData(inB);
+                snapB->Update();
+
+                inA = snapA->GetOutput();
+                inB = snapB->GetOutput();
+            }
 
 #ifdef DEBUG
             std::cout << "Exporting modPdA.vtk" << std::endl;
-            WriteVTK("modPdA.vtk", cleanA->GetOutput());
+            WriteVTK("modPdA.vtk", inA);
 
             std::cout << "Exporting modPdB.vtk" << std::endl;
-            WriteVTK("modPdB.vtk", cleanB->GetOutput());
+            WriteVTK("modPdB.vtk", inB);
 #endif
 
             // CellData sichern
 
-            cellDataA->DeepCopy(cleanA->GetOutput()->GetCellData());
-            cellDataB->DeepCopy(cleanB->GetOutput()->GetCellData());
+            cellDataA->ShallowCopy(inA->GetCellData());
+            cellDataB->ShallowCopy(inB->GetCellData());
 
-            // ermittelt kontaktstellen
+            if (TileSize > 0) {
+                int ret = ProcessTiles(inA, inB);
 
-// #ifdef DEBUG
+                FinishStats();
 
-            start = clock::now();
-// #endif
+                return ret;
+            }
 
-            vtkSmartPointer<vtkPolyDataContactFilter> cl = vtkSmartPointer<vtkPolyDataContactFilter>::New();
-            cl->SetInputConnection(0, cleanA->GetOutputPort());
-            cl->SetInputConnection(1, cleanB->GetOutputPort());
-            cl->Update();
+            CutResult res = ComputeCuts(inA, inB);
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+            if (res == CutResult::ABORTED) {
+                return Abort();
+            }
 
-            contLines->DeepCopy(cl->GetOutput());
+            if (res == CutResult::NO_CONTACT) {
+                vtkErrorMacro("Inputs have no contact.");
 
-#ifdef DEBUG
-            std::cout << "Exporting contLines.vtk" << std::endl;
-            WriteVTK("contLines.vtk", contLines);
+                return 1;
+            }
 
-            std::cout << "Exporting modPdA_1.vtk" << std::endl;
-            WriteVTK("modPdA_1.vtk", cl->GetOutput(1));
+            if (res == CutResult::FAILED) {
+                return 1;
+            }
 
-            std::cout << "Exporting modPdB_1.vtk" << std::endl;
-            WriteVTK("modPdB_1.vtk", cl->GetOutput(2));
-#endif
+            relsA.clear();
+            relsB.clear();
 
-            modPdA->DeepCopy(cl->GetOutput(1));
-            modPdB->DeepCopy(cl->GetOutput(2));
+            timePdA = pdA->GetMTime();
+            timePdB = pdB->GetMTime();
 
-            if (contLines->GetNumberOfCells() == 0) {
-                vtkErrorMacro("Inputs have no contact.");
+            if (!snapFile.empty()) {
+                StageTimer timer(stats, "Save");
+                SaveSnapshot(snapFile, snapHash);
+            }
 
-                return 1;
+        }
+
+        SetProgressRange(.7, .9);
+
+        {
+            StageTimer timer(stats, "Decompose");
+
+            if (relsA.empty()) {
+                numCellsA = modPdA->GetNumberOfCells();
             }
 
-            // in den CellDatas steht drin, welche polygone einander schneiden
+            if (relsB.empty()) {
+                numCellsB = modPdB->GetNumberOfCells();
+            }
 
-            vtkIntArray *contsA = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("cA"));
-            vtkIntArray *contsB = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("cB"));
+            DecPolys_(modPdA, involvedA, relsA);
+            DecPolys_(modPdB, involvedB, relsB);
+        }
 
-            vtkIntArray *sourcesA = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("sourcesA"));
-            vtkIntArray *sourcesB = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("sourcesB"));
+        if (GetAbortExecute()) {
+            return Abort();
+        }
+
+        SetProgressRange(.9, 1);
 
-            int i, numPts = contLines->GetNumberOfPoints();
+#ifdef DEBUG
+        std::cout << "Exporting modPdA_8.vtk" << std::endl;
+        WriteVTK("modPdA_8.vtk", modPdA);
 
-            vtkIdList *cells = vtkIdList::New();
+        std::cout << "Exporting modPdB_8.vtk" << std::endl;
+        WriteVTK("modPdB_8.vtk", modPdB);
+#endif
 
-            for (i = 0; i < numPts; i++) {
-                contLines->GetPointCells(i, cells);
+        {
+            StageTimer timer(stats, "Combine");
 
-                if (cells->GetNumberOfIds() == 1) {
-                    break;
-                }
+            if (MergeRegs) {
+                MergeRegions();
+            } else {
+                CombineRegions();
             }
+        }
 
-            cells->Delete();
+        FinishStats();
 
-            if (i < numPts) {
-                vtkErrorMacro("Contact ends suddenly at point " << i << ".");
+    }
 
-                return 1;
-            }
+    return 1;
 
-            // sichert die OrigCellIds
+}
 
-            vtkIntArray *origCellIdsA = vtkIntArray::SafeDownCast(modPdA->GetCellData()->GetScalars("OrigCellIds"));
-            vtkIntArray *origCellIdsB = vtkIntArray::SafeDownCast(modPdB->GetCellData()->GetScalars("OrigCellIds"));
+void vtkPolyDataBooleanFilter::FinishStats () {
 
-            cellIdsA->DeepCopy(origCellIdsA);
-            cellIdsB->DeepCopy(origCellIdsB);
+#ifdef VTKBOOL_PROFILE
+    {
+        // zuwachs dieses durchlaufs, gemessen an den enden der schritte
+        // ru_maxrss wäre der spitzenwert über die ganze lebensdauer des prozesses
 
-            for (int i = 0; i < modPdA->GetNumberOfCells(); i++) {
-                origCellIdsA->SetValue(i, i);
-            }
+        double rssMax = stats["rssStart"];
 
-            for (int i = 0; i < modPdB->GetNumberOfCells(); i++) {
-                origCellIdsB->SetValue(i, i);
+        for (auto &s : stats) {
+            if (s.first.compare(0, 3, "rss") == 0 && s.first != "rssGrowth") {
+                rssMax = std::max(rssMax, s.second);
             }
+        }
 
+        stats["rssGrowth"] = rssMax-stats["rssStart"];
+    }
+#endif
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+#ifdef DEBUG
+    for (auto &s : stats) {
+        if (s.first.compare(0, 4, "time") == 0) {
+            std::cout << s.first << ": " << s.second << "s" << std::endl;
+        }
+    }
+#endif
 
-            if (GetPolyStrips(modPdA, contsA, sourcesA, polyStripsA) ||
-                GetPolyStrips(modPdB, contsB, sourcesB, polyStripsB)) {
+}
 
-                vtkErrorMacro("Strips are invalid.");
+CutResult vtkPolyDataBooleanFilter::ComputeCuts (vtkPolyData *inA, vtkPolyData *inB, const std::vector<bool> *completeA, const std::vector<bool> *completeB) {
 
-                return 1;
+    // ermittelt kontaktstellen
+
+    vtkSmartPointer<vtkPolyDataContactFilter> cl = vtkSmartPointer<vtkPolyDataContactFilter>::New();
+    cl->SetInputData(0, inA);
+    cl->SetInputData(1, inB);
+    cl->AddObserver(vtkCommand::ProgressEvent, this, &vtkPolyDataBooleanFilter::ForwardProgress);
+
+    SetProgressRange(.05, .35);
+
+    {
+        StageTimer timer(stats, "Contact");
+        cl->Update();
+    }
+
+    if (GetAbortExecute()) {
+        return CutResult::ABORTED;
+    }
+
+    // die ausgaben von cl werden nur hier verwendet, eine kopie ist nicht nötig
+
+    contLines->ShallowCopy(cl->GetOutput());
+
+#ifdef DEBUG
+    std::cout << "Exporting contLines.vtk" << std::endl;
+    WriteVTK("contLines.vtk", contLines);
+
+    std::cout << "Exporting modPdA_1.vtk" << std::endl;
+    WriteVTK("modPdA_1.vtk", cl->GetOutput(1));
+
+    std::cout << "Exporting modPdB_1.vtk" << std::endl;
+    WriteVTK("modPdB_1.vtk", cl->GetOutput(2));
+#endif
+
+    modPdA->ShallowCopy(cl->GetOutput(1));
+    modPdB->ShallowCopy(cl->GetOutput(2));
+
+    if (contLines->GetNumberOfCells() == 0) {
+        return CutResult::NO_CONTACT;
+    }
+
+    // in den CellDatas steht drin, welche polygone einander schneiden
+
+    vtkIntArray *contsA = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("cA"));
+    vtkIntArray *contsB = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("cB"));
+
+    vtkIntArray *sourcesA = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("sourcesA"));
+    vtkIntArray *sourcesB = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("sourcesB"));
+
+    // in einer kachel enden die linien an den unvollständigen zellen
 
+    if (completeA == nullptr) {
+        int i, numPts = contLines->GetNumberOfPoints();
+
+        vtkIdList *cells = vtkIdList::New();
+
+        for (i = 0; i < numPts; i++) {
+            contLines->GetPointCells(i, cells);
+
+            if (cells->GetNumberOfIds() == 1) {
+                break;
             }
+        }
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+        cells->Delete();
 
-            // löst ein sehr spezielles problem
+        if (i < numPts) {
+            vtkErrorMacro("Contact ends suddenly at point " << i << ".");
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+            return CutResult::FAILED;
+        }
+    }
 
-            CollapseCaptPoints(modPdA, polyStripsA);
-            CollapseCaptPoints(modPdB, polyStripsB);
+    // sichert die OrigCellIds
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+    vtkIntArray *origCellIdsA = vtkIntArray::SafeDownCast(modPdA->GetCellData()->GetScalars("OrigCellIds"));
+    vtkIntArray *origCellIdsB = vtkIntArray::SafeDownCast(modPdB->GetCellData()->GetScalars("OrigCellIds"));
 
-            // trennt die polygone an den linien
+    cellIdsA->DeepCopy(origCellIdsA);
+    cellIdsB->DeepCopy(origCellIdsB);
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+    for (int i = 0; i < modPdA->GetNumberOfCells(); i++) {
+        origCellIdsA->SetValue(i, i);
+    }
 
-            CutCells(modPdA, polyStripsA);
-            CutCells(modPdB, polyStripsB);
+    for (int i = 0; i < modPdB->GetNumberOfCells(); i++) {
+        origCellIdsB->SetValue(i, i);
+    }
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+    SetProgressRange(.35, .45);
+
+    {
+        StageTimer timer(stats, "Strips");
+
+        if (GetPolyStrips(modPdA, contsA, sourcesA, polyStripsA, completeA) ||
+            GetPolyStrips(modPdB, contsB, sourcesB, polyStripsB, completeB)) {
+
+            vtkErrorMacro("Strips are invalid.");
+
+            return CutResult::FAILED;
+
+        }
+    }
+
+    if (GetAbortExecute()) {
+        return CutResult::ABORTED;
+    }
+
+    // löst ein sehr spezielles problem
+
+    {
+        StageTimer timer(stats, "Collapse");
+
+        CollapseCaptPoints(modPdA, polyStripsA);
+        CollapseCaptPoints(modPdB, polyStripsB);
+    }
+
+    // trennt die polygone an den linien
+
+    SetProgressRange(.45, .6);
+
+    {
+        StageTimer timer(stats, "Cut");
+
+        CutCells(modPdA, polyStripsA);
+        CutCells(modPdB, polyStripsB);
+    }
+
+    if (GetAbortExecute()) {
+        return CutResult::ABORTED;
+    }
+
+    SetProgressRange(.6, .7);
 
 #ifdef DEBUG
-            std::cout << "Exporting modPdA_2.vtk" << std::endl;
-            WriteVTK("modPdA_2.vtk", modPdA);
+    std::cout << "Exporting modPdA_2.vtk" << std::endl;
+    WriteVTK("modPdA_2.vtk", modPdA);
 
-            std::cout << "Exporting modPdB_2.vtk" << std::endl;
-            WriteVTK("modPdB_2.vtk", modPdB);
+    std::cout << "Exporting modPdB_2.vtk" << std::endl;
+    WriteVTK("modPdB_2.vtk", modPdB);
 #endif
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+    // locators und links werden von den folgenden schritten gemeinsam genutzt
 
-            RestoreOrigPoints(modPdA, polyStripsA);
-            RestoreOrigPoints(modPdB, polyStripsB);
+    double bndsA[6], bndsB[6];
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+    GetActiveBounds(modPdA, polyStripsA, bndsA);
+    GetActiveBounds(modPdB, polyStripsB, bndsB);
+
+    GeomContext ctxA(modPdA, bndsA),
+        ctxB(modPdB, bndsB);
+
+    {
+        StageTimer timer(stats, "Restore");
+
+        RestoreOrigPoints(modPdA, polyStripsA, ctxA);
+        RestoreOrigPoints(modPdB, polyStripsB, ctxB);
+    }
 
 #ifdef DEBUG
-            std::cout << "Exporting modPdA_3.vtk" << std::endl;
-            WriteVTK("modPdA_3.vtk", modPdA);
+    std::cout << "Exporting modPdA_3.vtk" << std::endl;
+    WriteVTK("modPdA_3.vtk", modPdA);
 
-            std::cout << "Exporting modPdB_3.vtk" << std::endl;
-            WriteVTK("modPdB_3.vtk", modPdB);
+    std::cout << "Exporting modPdB_3.vtk" << std::endl;
+    WriteVTK("modPdB_3.vtk", modPdB);
 #endif
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+    {
+        StageTimer timer(stats, "Overlaps");
 
-            ResolveOverlaps(modPdA, contsA, polyStripsA);
-            ResolveOverlaps(modPdB, contsB, polyStripsB);
+        ResolveOverlaps(modPdA, contsA, polyStripsA, ctxA);
+        ResolveOverlaps(modPdB, contsB, polyStripsB, ctxB);
+    }
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+#ifdef DEBUG
+    std::cout << "Exporting modPdA_4.vtk" << std::endl;
+    WriteVTK("modPdA_4.vtk", modPdA);
+
+    std::cout << "Exporting modPdB_4.vtk" << std::endl;
+    WriteVTK("modPdB_4.vtk", modPdB);
+#endif
+
+    {
+        StageTimer timer(stats, "Adjacent");
+
+        AddAdjacentPoints(modPdA, contsA, polyStripsA, ctxA);
+        AddAdjacentPoints(modPdB, contsB, polyStripsB, ctxB);
+    }
 
 #ifdef DEBUG
-            std::cout << "Exporting modPdA_4.vtk" << std::endl;
-            WriteVTK("modPdA_4.vtk", modPdA);
+    std::cout << "Exporting modPdA_5.vtk" << std::endl;
+    WriteVTK("modPdA_5.vtk", modPdA);
 
-            std::cout << "Exporting modPdB_4.vtk" << std::endl;
-            WriteVTK("modPdB_4.vtk", modPdB);
+    std::cout << "Exporting modPdB_5.vtk" << std::endl;
+    WriteVTK("modPdB_5.vtk", modPdB);
 #endif
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+    {
+        StageTimer timer(stats, "Disjoin");
 
-            AddAdjacentPoints(modPdA, contsA, polyStripsA);
-            AddAdjacentPoints(modPdB, contsB, polyStripsB);
+        DisjoinPolys(modPdA, polyStripsA, ctxA);
+        DisjoinPolys(modPdB, polyStripsB, ctxB);
+    }
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+#ifdef DEBUG
+    std::cout << "Exporting modPdA_6.vtk" << std::endl;
+    WriteVTK("modPdA_6.vtk", modPdA);
+
+    std::cout << "Exporting modPdB_6.vtk" << std::endl;
+    WriteVTK("modPdB_6.vtk", modPdB);
+#endif
+
+    {
+        StageTimer timer(stats, "Merge");
+
+        MergePoints(modPdA, polyStripsA, ctxA);
+        MergePoints(modPdB, polyStripsB, ctxB);
+    }
 
 #ifdef DEBUG
-            std::cout << "Exporting modPdA_5.vtk" << std::endl;
-            WriteVTK("modPdA_5.vtk", modPdA);
+    std::cout << "Exporting modPdA_7.vtk" << std::endl;
+    WriteVTK("modPdA_7.vtk", modPdA);
 
-            std::cout << "Exporting modPdB_5.vtk" << std::endl;
-            WriteVTK("modPdB_5.vtk", modPdB);
+    std::cout << "Exporting modPdB_7.vtk" << std::endl;
+    WriteVTK("modPdB_7.vtk", modPdB);
 #endif
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+    ctxA.AddStats(stats, "A");
+    ctxB.AddStats(stats, "B");
 
-            DisjoinPolys(modPdA, polyStripsA);
-            DisjoinPolys(modPdB, polyStripsB);
+    involvedA.clear();
+    involvedB.clear();
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+    int numLines = contLines->GetNumberOfCells();
 
-#ifdef DEBUG
-            std::cout << "Exporting modPdA_6.vtk" << std::endl;
-            WriteVTK("modPdA_6.vtk", modPdA);
+    for (int i = 0; i < numLines; i++) {
+        involvedA.insert(contsA->GetValue(i));
+        involvedB.insert(contsB->GetValue(i));
+    }
+
+    return CutResult::OK;
+
+}
+
+
+int vtkPolyDataBooleanFilter::ProcessTiles (vtkPolyData *inA, vtkPolyData *inB) {
+
+    // nur der überlappungsbereich der eingaben wird gekachelt
+
+    double bndsA[6], bndsB[6], overlap[6];
+
+    inA->GetBounds(bndsA);
+    inB->GetBounds(bndsB);
+
+    for (int i = 0; i < 3; i++) {
+        overlap[2*i] = std::max(bndsA[2*i], bndsB[2*i])-1e-6;
+        overlap[2*i+1] = std::min(bndsA[2*i+1], bndsB[2*i+1])+1e-6;
+
+        if (overlap[2*i] > overlap[2*i+1]) {
+            vtkErrorMacro("Inputs have no contact.");
+
+            return Abort();
+        }
+    }
+
+    TiledMesh meshA(inA), meshB(inB);
+
+    // alle zellen, mit denen eine zuständige zelle in berührung kommen kann, liegen innerhalb des halos
+
+    double halo = 2*std::max(meshA.GetMaxExtent(), meshB.GetMaxExtent())+1e-6;
+
+    TileGrid grid(overlap, TileSize);
+
+    vtkIdType numTiles = grid.GetNumberOfTiles();
+
+    std::vector<std::vector<vtkIdType>> tileCellsA(numTiles), tileCellsB(numTiles);
+
+    StatsType total;
+
+    {
+        StageTimer timer(total, "Tiles");
+
+        meshA.Distribute(grid, halo, tileCellsA);
+        meshB.Distribute(grid, halo, tileCellsB);
+    }
 
-            std::cout << "Exporting modPdB_6.vtk" << std::endl;
-            WriteVTK("modPdB_6.vtk", modPdB);
+#ifdef VTKBOOL_PROFILE
+    total["rssStart"] = stats["rssStart"];
 #endif
 
-// #ifdef DEBUG
-            start = clock::now();
-// #endif
+    // die kontaktlinien der zuständigen zellen, cA und cB verweisen auf die zellen von inA und inB
 
-            MergePoints(modPdA, polyStripsA);
-            MergePoints(modPdB, polyStripsB);
+    vtkPoints *linePts = vtkPoints::New();
+    linePts->SetDataTypeToDouble();
 
-// #ifdef DEBUG
-            times.push_back(clock::now()-start);
-// #endif
+    vtkCellArray *lineCells = vtkCellArray::New();
 
-#ifdef DEBUG
-            std::cout << "Exporting modPdA_7.vtk" << std::endl;
-            WriteVTK("modPdA_7.vtk", modPdA);
+    vtkIntArray *linesA = vtkIntArray::New();
+    linesA->SetName("cA");
+
+    vtkIntArray *linesB = vtkIntArray::New();
+    linesB->SetName("cB");
+
+    vtkIdType t, numCut = 0;
+
+    for (t = 0; t < numTiles; t++) {
+        if (tileCellsA[t].empty() || tileCellsB[t].empty()) {
+            continue;
+        }
+
+        progOffset = .9*t/numTiles;
+        progScale = .9/numTiles;
+
+        TilePart partA(inA, tileCellsA[t], grid, t, halo, overlap),
+            partB(inB, tileCellsB[t], grid, t, halo, overlap);
+
+        tileCellsA[t].clear();
+        tileCellsA[t].shrink_to_fit();
+
+        tileCellsB[t].clear();
+        tileCellsB[t].shrink_to_fit();
+
+        stats.clear();
+
+        CutResult res = ComputeCuts(partA.pd, partB.pd, &partA.complete, &partB.complete);
+
+        if (res == CutResult::OK) {
+            relsA.clear();
+            relsB.clear();
+
+            StageTimer timer(stats, "Decompose");
+
+            DecPolys_(modPdA, involvedA, relsA);
+            DecPolys_(modPdB, involvedB, relsB);
+        }
+
+        if (res == CutResult::ABORTED || res == CutResult::FAILED || GetAbortExecute()) {
+            linesB->Delete();
+            linesA->Delete();
+            lineCells->Delete();
+            linePts->Delete();
+
+            return Abort();
+        }
+
+        if (res == CutResult::OK) {
+            numCut++;
+
+            StageTimer timer(stats, "Regions");
+
+            CollectTile(partA, partB, meshA, meshB, linePts, lineCells, linesA, linesB);
+        }
+
+        // die werte der kacheln werden summiert, beim rss zählt das maximum
+
+        for (auto &s : stats) {
+            if (s.first.compare(0, 3, "rss") == 0) {
+                total[s.first] = std::max(total[s.first], s.second);
+            } else {
+                total[s.first] += s.second;
+            }
+        }
+    }
+
+    progOffset = 0;
+    progScale = 1;
+
+    stats = total;
+
+    stats["numTiles"] = numTiles;
+    stats["numTilesCut"] = numCut;
+
+    // die zwischenstände der letzten kachel werden nicht mehr gebraucht, der nächste aufruf beginnt von vorn
+
+    modPdA->Initialize();
+    modPdB->Initialize();
+
+    polyStripsA.clear();
+    polyStripsB.clear();
+
+    relsA.clear();
+    relsB.clear();
+
+    involvedA.clear();
+    involvedB.clear();
+
+    timePdA = 0;
+    timePdB = 0;
+
+    vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+    lines->SetPoints(linePts);
+    lines->SetLines(lineCells);
+    lines->GetCellData()->AddArray(linesA);
+    lines->GetCellData()->AddArray(linesB);
+
+    linesB->Delete();
+    linesA->Delete();
+    lineCells->Delete();
+    linePts->Delete();
+
+    if (numCut == 0) {
+        vtkErrorMacro("Inputs have no contact.");
+
+        resultA->Initialize();
+        resultB->Initialize();
+
+        return 1;
+    }
+
+    SetProgressRange(.9, 1);
+
+    // wie in CombineRegions
 
-            std::cout << "Exporting modPdB_7.vtk" << std::endl;
-            WriteVTK("modPdB_7.vtk", modPdB);
+    int comb[] = {LOC_OUTSIDE, LOC_OUTSIDE};
+
+    if (OperMode == OPER_INTERSECTION) {
+        comb[0] = LOC_INSIDE;
+        comb[1] = LOC_INSIDE;
+    } else if (OperMode == OPER_DIFFERENCE) {
+        comb[1] = LOC_INSIDE;
+    } else if (OperMode == OPER_DIFFERENCE2) {
+        comb[0] = LOC_INSIDE;
+    }
+
+    bool uninvolved[] = {OperMode == OPER_UNION || OperMode == OPER_DIFFERENCE,
+        OperMode == OPER_UNION || OperMode == OPER_DIFFERENCE2};
+
+    auto Select = [&] (int side, int loc) {
+        if (MergeRegs) {
+            return 1;
+        }
+
+        if (loc == LOC_NONE) {
+            return uninvolved[side] ? 1 : 0;
+        }
+
+        if (loc != comb[side]) {
+            return 0;
+        }
+
+        // nach innen zeigende normalen umkehren
+        return OperMode != OPER_INTERSECTION && comb[side] == LOC_INSIDE ? 2 : 1;
+    };
+
+    StageTimer timer(stats, "Combine");
+
+    vtkSmartPointer<vtkPolyData> regsA = meshA.GetRegions([&Select] (int loc) { return Select(0, loc); });
+    vtkSmartPointer<vtkPolyData> regsB = meshB.GetRegions([&Select] (int loc) { return Select(1, loc); });
+
+    contLines->ShallowCopy(lines);
+
+    CombineOutputs(regsA, regsB, nullptr, nullptr);
+
+    return 1;
+
+}
+
+void vtkPolyDataBooleanFilter::CollectTile (const TilePart &partA, const TilePart &partB, TiledMesh &meshA, TiledMesh &meshB,
+    vtkPoints *linePts, vtkCellArray *lineCells, vtkIntArray *linesA, vtkIntArray *linesB) {
+
+    // nur die vollständigen zellen sind richtig geschnitten
+
+    vtkSmartPointer<vtkPolyData> cutA = vtkSmartPointer<vtkPolyData>::New();
+    FilterCells(modPdA, relsA, cutA, &partA.complete);
+
+    vtkSmartPointer<vtkPolyData> cutB = vtkSmartPointer<vtkPolyData>::New();
+    FilterCells(modPdB, relsB, cutB, &partB.complete);
+
+    DisjointSets regionsA(cutA->GetNumberOfPoints()),
+        regionsB(cutB->GetNumberOfPoints());
+
+    ConnectCells(cutA, regionsA);
+    ConnectCells(cutB, regionsB);
+
+    std::vector<bool> skipA, skipB;
+
+    partA.GetIncompletePoints(modPdA, skipA);
+    partB.GetIncompletePoints(modPdB, skipB);
+
+    // die linien zwischen vollständigen zellen
+
+    vtkIntArray *contsA = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("cA"));
+    vtkIntArray *contsB = vtkIntArray::SafeDownCast(contLines->GetCellData()->GetScalars("cB"));
+
+    vtkSmartPointer<vtkCellArray> tileCells = vtkSmartPointer<vtkCellArray>::New();
+
+    vtkIdType i, num, *line, numLines = contLines->GetNumberOfCells();
+
+    double pt[3];
+
+    for (i = 0; i < numLines; i++) {
+        if (contLines->GetCellType(i) == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        int cA = contsA->GetValue(i),
+            cB = contsB->GetValue(i);
+
+        if (!partA.complete[cA] || !partB.complete[cB]) {
+            continue;
+        }
+
+        contLines->GetCellPoints(i, num, line);
+
+        tileCells->InsertNextCell(num, line);
+
+        if (partA.owned[cA]) {
+            lineCells->InsertNextCell(num);
+
+            for (vtkIdType j = 0; j < num; j++) {
+                contLines->GetPoint(line[j], pt);
+                lineCells->InsertCellPoint(linePts->InsertNextPoint(pt));
+            }
+
+            linesA->InsertNextValue(partA.cellIds[cA]);
+            linesB->InsertNextValue(partB.cellIds[cB]);
+        }
+    }
+
+    vtkSmartPointer<vtkPolyData> tileLines = vtkSmartPointer<vtkPolyData>::New();
+    tileLines->SetPoints(contLines->GetPoints());
+    tileLines->SetLines(tileCells);
+
+    std::map<int, int> locsA, locsB;
+
+    if (tileLines->GetNumberOfCells() > 0) {
+        LocateRegions(tileLines, cutA, cutB,
+            [&regionsA] (vtkIdType id) { return static_cast<int>(regionsA.Find(id)); },
+            [&regionsB] (vtkIdType id) { return static_cast<int>(regionsB.Find(id)); },
+            locsA, locsB, &skipA, &skipB);
+    }
+
+    meshA.AddTile(partA, cutA, regionsA, locsA);
+    meshB.AddTile(partB, cutB, regionsB, locsB);
+
+}
+
+void vtkPolyDataBooleanFilter::SetProgressRange (double start, double end) {
+    progStart = progOffset+progScale*start;
+    progEnd = progOffset+progScale*end;
+    progCount = 0;
+
+    UpdateProgress(progStart);
+}
+
+bool vtkPolyDataBooleanFilter::StepProgress (vtkPolyData *pd, vtkIdType i, vtkIdType n) {
+    // UpdateProgress ruft die observer auf, daher nur bei jedem 16. schritt
+    if ((progCount++ & 15) == 0 && n > 0) {
+        // modPdA belegt die erste hälfte des abschnitts, modPdB die zweite
+        double f = (pd == modPdA ? 0 : .5)+.5*i/n;
+
+        UpdateProgress(progStart+(progEnd-progStart)*f);
+    }
+
+    return GetAbortExecute() != 0;
+}
+
+void vtkPolyDataBooleanFilter::ForwardProgress (vtkObject *caller, unsigned long vtkNotUsed(event), void *data) {
+    UpdateProgress(progStart+(progEnd-progStart)*(*static_cast<double*>(data)));
+
+    if (GetAbortExecute()) {
+        vtkAlgorithm::SafeDownCast(caller)->SetAbortExecute(1);
+    }
+}
+
+std::string vtkPolyDataBooleanFilter::GetSnapshotFile (vtkPolyData *pdA, vtkPolyData *pdB, std::uint64_t &hash) {
+    ContentHash h;
+
+    h.Add<std::int32_t>(SNAPSHOT_VERSION);
+
+    // die exakten prädikate ergeben andere kontaktlinien und schnitte
+#ifdef EXACT_PREDICATES
+    h.Add<std::int32_t>(1);
+#else
+    h.Add<std::int32_t>(0);
 #endif
 
-            involvedA.clear();
-            involvedB.clear();
+    h.Add(SnapResolution);
+
+    h.Add(pdA);
+    h.Add(pdB);
+
+    hash = h.Get();
+
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+    return std::string(SnapshotDir) + "/" + name + ".vtkbool";
+}
+
+bool vtkPolyDataBooleanFilter::LoadSnapshot (const std::string &file, std::uint64_t hash) {
+    SnapshotReader reader(file);
 
-            int numLines = contLines->GetNumberOfCells();
+    if (!reader.Open(hash)) {
+        return false;
+    }
 
-            for (int i = 0; i < numLines; i++) {
-                involvedA.insert(contsA->GetValue(i));
-                involvedB.insert(contsB->GetValue(i));
-            }
+    try {
+        reader.Read(contLines);
+        reader.Read(modPdA);
+        reader.Read(modPdB);
 
-            relsA.clear();
-            relsB.clear();
+        reader.Read(cellDataA);
+        reader.Read(cellDataB);
 
-            timePdA = pdA->GetMTime();
-            timePdB = pdB->GetMTime();
+        int attr;
 
-        }
+        cellIdsA->DeepCopy(reader.ReadArray(attr));
+        cellIdsB->DeepCopy(reader.ReadArray(attr));
 
-// #ifdef DEBUG
-        times.push_back(clock::now()-start);
-// #endif
+        reader.Read(involvedA);
+        reader.Read(involvedB);
 
-        DecPolys_(modPdA, involvedA, relsA);
-        DecPolys_(modPdB, involvedB, relsB);
+    } catch (const std::exception &e) {
+        vtkWarningMacro("Snapshot " << file << " is invalid: " << e.what());
 
-// #ifdef DEBUG
-        times.push_back(clock::now()-start);
-// #endif
+        // die teilweise gelesenen daten werden bei der neuberechnung ersetzt
+        return false;
+    }
 
-#ifdef DEBUG
-        std::cout << "Exporting modPdA_8.vtk" << std::endl;
-        WriteVTK("modPdA_8.vtk", modPdA);
+    // die strips werden nach MergePoints nicht mehr gebraucht
+    polyStripsA.clear();
+    polyStripsB.clear();
 
-        std::cout << "Exporting modPdB_8.vtk" << std::endl;
-        WriteVTK("modPdB_8.vtk", modPdB);
-#endif
+    return true;
+}
 
-// #ifdef DEBUG
-        start = clock::now();
-// #endif
+void vtkPolyDataBooleanFilter::SaveSnapshot (const std::string &file, std::uint64_t hash) {
+    std::vector<vtkFieldData*> fds {contLines->GetCellData(), modPdA->GetCellData(), modPdB->GetCellData(),
+        contLines->GetPointData(), modPdA->GetPointData(), modPdB->GetPointData(), cellDataA, cellDataB};
 
-        if (MergeRegs) {
-            MergeRegions();
-        } else {
-            CombineRegions();
+    for (vtkFieldData *fd : fds) {
+        if (!SnapshotWriter::IsWritable(fd)) {
+            vtkWarningMacro("Snapshot not written, the inputs contain non-numeric arrays.");
+            return;
         }
+    }
 
-// #ifdef DEBUG
-        times.push_back(clock::now()-start);
-// #endif
+    try {
+        SnapshotWriter writer(file, hash);
 
+        writer.Write(contLines);
+        writer.Write(modPdA);
+        writer.Write(modPdB);
 
-// #ifdef DEBUG
-        double sum = std::chrono::duration_cast<std::chrono::duration<double>>(std::accumulate(times.begin(), times.end(), clock::duration())).count();
+        writer.Write(cellDataA);
+        writer.Write(cellDataB);
 
-        std::vector<clock::duration>::const_iterator itr;
-        for (itr = times.begin(); itr != times.end(); itr++) {
-            double time = std::chrono::duration_cast<std::chrono::duration<double>>(*itr).count();
+        writer.Write(cellIdsA);
+        writer.Write(cellIdsB);
 
-            std::cout << "Time " << (itr-times.begin())
-                << ": " << time << "s (" << (time/sum*100) << "%)"
-                << std::endl;
-        }
-// #endif
+        writer.Write(involvedA);
+        writer.Write(involvedB);
 
+        writer.Close();
+
+    } catch (const std::exception &e) {
+        vtkWarningMacro("Snapshot not written: " << e.what());
     }
+}
 
-    return 1;
+int vtkPolyDataBooleanFilter::Abort () {
+    // der nächste aufruf beginnt von vorn
+    timePdA = 0;
+    timePdB = 0;
+
+    relsA.clear();
+    relsB.clear();
 
+    progOffset = 0;
+    progScale = 1;
+
+    resultA->Initialize();
+    resultB->Initialize();
+
+    return 1;
 }
 
 void vtkPolyDataBooleanFilter::GetStripPoints (vtkPolyData *pd, vtkIntArray *sources, PStrips &pStrips, IdsType &lines) {
@@ -620,7 +1196,7 @@ void vtkPolyDataBooleanFilter::GetStripPoints (vtkPolyData *pd, vtkIntArray *sou
 
 }
 
-bool vtkPolyDataBooleanFilter::GetPolyStrips (vtkPolyData *pd, vtkIntArray *conts, vtkIntArray *sources, PolyStripsType &polyStrips) {
+bool vtkPolyDataBooleanFilter::GetPolyStrips (vtkPolyData *pd, vtkIntArray *conts, vtkIntArray *sources, PolyStripsType &polyStrips, const std::vector<bool> *complete) {
 #ifdef DEBUG
     std::cout << "GetPolyStrips()" << std::endl;
 #endif
@@ -632,6 +1208,10 @@ bool vtkPolyDataBooleanFilter::GetPolyStrips (vtkPolyData *pd, vtkIntArray *cont
     for (int i = 0; i < conts->GetNumberOfTuples(); i++) {
         int poly = conts->GetValue(i);
 
+        if (complete != nullptr && !(*complete)[poly]) {
+            continue;
+        }
+
         // if (poly != 95) {
         //     continue;
         // }
@@ -643,8 +1223,15 @@ bool vtkPolyDataBooleanFilter::GetPolyStrips (vtkPolyData *pd, vtkIntArray *cont
 
     std::map<int, IdsType>::iterator itr;
 
+    vtkIdType step = 0, numSteps = polyLines.size();
+
     for (itr = polyLines.begin(); itr != polyLines.end(); ++itr) {
 
+        // abgebrochen, die strips werden verworfen
+        if (StepProgress(pd, step++, numSteps)) {
+            return false;
+        }
+
         IdsType &lines = itr->second;
         RemoveDuplicates(lines);
 
@@ -933,9 +1520,7 @@ bool vtkPolyDataBooleanFilter::GetPolyStrips (vtkPolyData *pd, vtkIntArray *cont
 
         cell->Delete();
 
-        AABB tree;
-
-        std::vector<std::shared_ptr<Line>> lines;
+        std::vector<Line> lines;
 
         for (itr3 = strips.begin(); itr3 != strips.end(); ++itr3) {
             const StripType &strip = *itr3;
@@ -951,42 +1536,29 @@ bool vtkPolyDataBooleanFilter::GetPolyStrips (vtkPolyData *pd, vtkIntArray *cont
 
                 int grp = itr3-strips.begin();
 
-                lines.emplace_back(new Line({ptA, itr4->ind}, {ptB, (itr4+1)->ind}, grp));
+                lines.push_back(Line({ptA, itr4->ind}, {ptB, (itr4+1)->ind}, grp));
             }
 
         }
 
-        for (auto &line : lines) {
-            // std::cout << *line << std::endl;
-
-            tree.InsertObj(line);
-        }
+        AABB<Line> tree(lines);
 
         Bnds bnds(-E, E, -E, E);
 
-        std::vector<std::shared_ptr<Line>>::const_iterator itr5;
-        std::vector<std::shared_ptr<Obj>>::const_iterator itr6;
-
-        for (itr5 = lines.begin(); itr5 != lines.end(); ++itr5) {
-            auto found = tree.Search(*itr5);
-
-            const Line &lA = **itr5;
-
-            for (itr6 = found.begin(); itr6 != found.end(); ++itr6) {
-                // std::cout << itr6->use_count() << std::endl;
-
-                const Line &lB = dynamic_cast<Line&>(**itr6);
-
+        for (const Line &lA : lines) {
+            bool found = tree.Search(lA.bb, [&](const Line &lB) {
                 // die linien dürfen nicht zum gleichen strip gehören und sich nicht an den enden berühren
 
-                if (lA.grp != lB.grp
+                return lA.grp != lB.grp
                     && lA.pA.id != lB.pA.id
                     && lA.pA.id != lB.pB.id
                     && lA.pB.id != lB.pA.id
                     && lA.pB.id != lB.pB.id
-                    && Intersect2(lA.pA.pt, lA.pB.pt, lB.pA.pt, lB.pB.pt, bnds)) {
-                    return true;
-                }
+                    && Intersect2(lA.pA.pt, lA.pB.pt, lB.pA.pt, lB.pB.pt, bnds);
+            });
+
+            if (found) {
+                return true;
             }
         }
 
@@ -1085,8 +1657,14 @@ void vtkPolyDataBooleanFilter::CutCells (vtkPolyData *pd, PolyStripsType &polySt
 
     PolyStripsType::iterator itr;
 
+    vtkIdType step = 0, numSteps = polyStrips.size();
+
     for (itr = polyStrips.begin(); itr != polyStrips.end(); ++itr) {
 
+        if (StepProgress(pd, step++, numSteps)) {
+            return;
+        }
+
         int polyInd = itr->first;
         PStrips &pStrips = itr->second;
 
@@ -1589,150 +2167,415 @@ void vtkPolyDataBooleanFilter::CutCells (vtkPolyData *pd, PolyStripsType &polySt
                             return &end == &r;
                         });
 
-                        if (_e != edge.end()) {
-                            for (itr7 = edge.begin(); itr7 != edge.end(); ++itr7) {
-                                StripPtR &sp = *itr7;
-                                StripPt &_sp = pts[sp.ind];
-                                auto &history = _sp.history;
+                        if (_e != edge.end()) {
+                            for (itr7 = edge.begin(); itr7 != edge.end(); ++itr7) {
+                                StripPtR &sp = *itr7;
+                                StripPt &_sp = pts[sp.ind];
+                                auto &history = _sp.history;
+
+                                if (&sp != &end) {
+                                    if (_sp.t < pts[end.ind].t) {
+                                        history.push_back({history.back().f, end.desc[1]});
+                                    } else {
+                                        history.push_back({end.desc[0], history.back().g});
+                                    }
+
+                                }
+
+                            }
+                        }
+
+                        // sonderfall
+                        if (edge.size() > 1) {
+                            StripPtR &a = edge.front(),
+                                &b = *(edge.begin()+1);
+
+                            if (a.ind == b.ind
+                                && b.strip == idx
+                                && pts[a.ind].capt == CAPT_A) { // sollte weg
+
+#ifdef DEBUG
+                                std::cout << "~3 ref " << a.ref;
+#endif
+
+                                if (b.side == SIDE_START) {
+                                    a.ref = b.desc[0];
+                                } else {
+                                    a.ref = b.desc[1];
+                                }
+
+#ifdef DEBUG
+                                std::cout << " -> " << a.ref << " (from strip " << b.strip << ", ind " << b.ind << ")" << std::endl;
+#endif
+
+                            }
+                        }
+
+                    }
+
+                    // doppelte punkte entfernen
+
+                    double ptA[3], ptB[3];
+
+                    IdsType::const_iterator itrA, itrB;
+
+                    for (auto &newPoly : newPolys) {
+                        IdsType _newPoly;
+
+                        for (itrA = newPoly.begin(); itrA != newPoly.end(); ++itrA) {
+                            itrB = itrA+1;
+
+                            if (itrB == newPoly.end()) {
+                                itrB = newPoly.begin();
+                            }
+
+                            pd->GetPoint(*itrA, ptA);
+                            pd->GetPoint(*itrB, ptB);
+
+                            double d = GetD(ptA, ptB);
+
+                            if (d > 1e-6) {
+                                _newPoly.push_back(*itrA);
+                            } else {
+#ifdef DEBUG
+                                std::cout << "removing " << *itrA << std::endl;
+#endif
+                            }
+                        }
+
+                        newPoly.swap(_newPoly);
+                    }
+
+                    // prüft, ob die erstellten polygone gültig sind
+
+                    if (newPolys[0].size() > 2) {
+                        polys.push_back(newPolys[0]);
+                    }
+
+                    if (HasArea(strip) && newPolys[1].size() > 2) {
+                        polys.push_back(newPolys[1]);
+                    }
+
+                    cycle = 0;
+
+                    break;
+
+                } else {
+                    polys.push_back(next);
+
+                    cycle++;
+                }
+
+            }
+
+        }
+
+        // erzeugte polys hinzufügen
+
+        IdsType descIds;
+
+        for (itr9 = polys.begin(); itr9 != polys.end(); ++itr9) {
+            IdsType &p = *itr9;
+
+            int num = p.size();
+
+            vtkIdList *cell = vtkIdList::New();
+            cell->SetNumberOfIds(num);
+
+            for (int i = 0; i < num; i++) {
+                cell->SetId(i, p[i]);
+            }
+
+            descIds.push_back(pd->InsertNextCell(VTK_POLYGON, cell));
+
+            origCellIds->InsertNextValue(origId);
+
+            cell->Delete();
+        }
+
+        pd->DeleteCell(polyInd);
+
+        // holes verarbeiten
+
+        if (!holes.empty()) {
+            _Wrapper w(pd, descIds, origId);
+
+            for (auto& hole : holes) {
+                w.Add(hole);
+            }
+
+            w.MergeAll();
+        }
+
+    }
+
+    pd->RemoveDeletedCells();
+    pd->BuildCells();
+
+}
+
+GeomContext::GeomContext (vtkPolyData *pd, const double *_bnds) : pd(pd), numScannedPts(0), numScannedCells(0), numBuilt(0), numVisible(0), locStale(false), linksValid(false), locBuilds(0), linkBuilds(0), locTime(0), linkTime(0) {
+    Cpy(bnds, _bnds, 6);
+}
+
+void GeomContext::ScanPoints () {
+    vtkIdType i, numPts = pd->GetNumberOfPoints();
+
+    double pt[3];
+
+    for (i = numScannedPts; i < numPts; i++) {
+        pd->GetPoint(i, pt);
+
+        if (InsideBounds(bnds, pt)) {
+            activePts.push_back(i);
+        }
+    }
+
+    numScannedPts = numPts;
+}
+
+void GeomContext::ScanCells () {
+    // eine zelle ist aktiv, wenn einer ihrer punkte innerhalb von bnds liegt
+
+    vtkIdType i, j, numCells = pd->GetNumberOfCells(), num, *poly;
+
+    double pt[3];
+
+    for (i = numScannedCells; i < numCells; i++) {
+        pd->GetCellPoints(i, num, poly);
+
+        for (j = 0; j < num; j++) {
+            pd->GetPoint(poly[j], pt);
+
+            if (InsideBounds(bnds, pt)) {
+                activeCells.push_back(i);
+                break;
+            }
+        }
+    }
+
+    numScannedCells = numCells;
+}
+
+void GeomContext::Begin () {
+    using clock = std::chrono::steady_clock;
+
+    numVisible = pd->GetNumberOfPoints();
+
+    // neu erstellen, wenn punkte verschoben wurden oder zu viele linear durchsucht werden müssten
+
+    if (!loc || locStale || numVisible-numBuilt > std::max<vtkIdType>(64, numBuilt/4)) {
+        clock::time_point start = clock::now();
+
+        ScanPoints();
+
+        loc.reset();
+        loc.reset(new SubLocator(pd, bnds, activePts));
+
+        numBuilt = numVisible;
+        locStale = false;
+
+        locBuilds++;
+        locTime += std::chrono::duration<double>(clock::now()-start).count();
+    }
+}
+
+void GeomContext::FindPoints (const double *pt, vtkIdList *pts, double tol) {
+    loc->FindPoints(pt, pts, tol);
+
+    // die angehängten punkte
+
+    double c[3], v[3];
+
+    for (vtkIdType i = numBuilt; i < numVisible; i++) {
+        pd->GetPoint(i, c);
+        vtkMath::Subtract(pt, c, v);
+
+        if (vtkMath::Norm(v) < tol) {
+            pts->InsertNextId(i);
+        }
+    }
+}
+
+void GeomContext::SetPoint (vtkIdType id, const double *pt) {
+    pd->GetPoints()->SetPoint(id, pt);
+
+    // der locator kennt nur die alten koordinaten, wird aber erst beim nächsten Begin() ersetzt
+    if (id < numBuilt) {
+        locStale = true;
+    }
+}
+
+void GeomContext::BuildLinks (bool force) {
+    using clock = std::chrono::steady_clock;
+
+    if (force || !linksValid) {
+        clock::time_point start = clock::now();
+
+        ScanCells();
+
+        links.clear();
+
+        vtkIdType i, num, *poly;
+
+        for (vtkIdType cellId : activeCells) {
+            pd->GetCellPoints(cellId, num, poly);
 
-                                if (&sp != &end) {
-                                    if (_sp.t < pts[end.ind].t) {
-                                        history.push_back({history.back().f, end.desc[1]});
-                                    } else {
-                                        history.push_back({end.desc[0], history.back().g});
-                                    }
+            for (i = 0; i < num; i++) {
+                links[poly[i]].push_back(cellId);
+            }
+        }
 
-                                }
+        linksValid = true;
 
-                            }
-                        }
+        linkBuilds++;
+        linkTime += std::chrono::duration<double>(clock::now()-start).count();
+    }
+}
 
-                        // sonderfall
-                        if (edge.size() > 1) {
-                            StripPtR &a = edge.front(),
-                                &b = *(edge.begin()+1);
+void GeomContext::GetPointCells (vtkIdType id, vtkIdList *cells) {
+    assert(linksValid);
 
-                            if (a.ind == b.ind
-                                && b.strip == idx
-                                && pts[a.ind].capt == CAPT_A) { // sollte weg
+    cells->Reset();
 
-#ifdef DEBUG
-                                std::cout << "~3 ref " << a.ref;
-#endif
+    auto itr = links.find(id);
 
-                                if (b.side == SIDE_START) {
-                                    a.ref = b.desc[0];
-                                } else {
-                                    a.ref = b.desc[1];
-                                }
+    if (itr != links.end()) {
+        for (vtkIdType cellId : itr->second) {
+            cells->InsertNextId(cellId);
+        }
+    }
+}
 
-#ifdef DEBUG
-                                std::cout << " -> " << a.ref << " (from strip " << b.strip << ", ind " << b.ind << ")" << std::endl;
-#endif
+vtkIdType GeomContext::InsertNextPoint (const double *pt) {
+    vtkIdType id = pd->GetPoints()->InsertNextPoint(pt);
 
-                            }
-                        }
+    if (linksValid) {
+        // ein platz für die zelle aus ReplaceCellPoint
+        links[id].reserve(1);
+    }
 
-                    }
+    return id;
+}
 
-                    // doppelte punkte entfernen
+void GeomContext::ReplaceCellPoint (vtkIdType cellId, vtkIdType oldId, vtkIdType newId) {
+    pd->ReplaceCellPoint(cellId, oldId, newId);
 
-                    double ptA[3], ptB[3];
+    if (linksValid) {
+        auto &cells = links[oldId];
+        cells.erase(std::remove(cells.begin(), cells.end(), cellId), cells.end());
 
-                    IdsType::const_iterator itrA, itrB;
+        links[newId].push_back(cellId);
+    }
+}
 
-                    for (auto &newPoly : newPolys) {
-                        IdsType _newPoly;
+vtkIdType GeomContext::InsertNextCell (int type, vtkIdType num, const vtkIdType *pts) {
+    vtkIdType cellId = pd->InsertNextCell(type, num, pts);
 
-                        for (itrA = newPoly.begin(); itrA != newPoly.end(); ++itrA) {
-                            itrB = itrA+1;
+    if (linksValid) {
+        for (vtkIdType i = 0; i < num; i++) {
+            links[pts[i]].push_back(cellId);
+        }
+    }
 
-                            if (itrB == newPoly.end()) {
-                                itrB = newPoly.begin();
-                            }
+    // wird beim nächsten ScanCells erfasst
 
-                            pd->GetPoint(*itrA, ptA);
-                            pd->GetPoint(*itrB, ptB);
+    return cellId;
+}
 
-                            double d = GetD(ptA, ptB);
+void GeomContext::DeleteCell (vtkIdType cellId) {
+    if (linksValid) {
+        vtkIdType i, num, *poly;
+        pd->GetCellPoints(cellId, num, poly);
 
-                            if (d > 1e-6) {
-                                _newPoly.push_back(*itrA);
-                            } else {
-#ifdef DEBUG
-                                std::cout << "removing " << *itrA << std::endl;
-#endif
-                            }
-                        }
+        for (i = 0; i < num; i++) {
+            auto &cells = links[poly[i]];
+            cells.erase(std::remove(cells.begin(), cells.end(), cellId), cells.end());
+        }
+    }
 
-                        newPoly.swap(_newPoly);
-                    }
+    pd->DeleteCell(cellId);
 
-                    // prüft, ob die erstellten polygone gültig sind
+    deleted.push_back(cellId);
+}
 
-                    if (newPolys[0].size() > 2) {
-                        polys.push_back(newPolys[0]);
-                    }
+void GeomContext::RemoveDeletedCells () {
+    ScanCells();
 
-                    if (HasArea(strip) && newPolys[1].size() > 2) {
-                        polys.push_back(newPolys[1]);
-                    }
+    std::sort(deleted.begin(), deleted.end());
+    deleted.erase(std::unique(deleted.begin(), deleted.end()), deleted.end());
 
-                    cycle = 0;
+    // die gelöschten fallen weg, die übrigen rücken um die anzahl der davor gelöschten auf
 
-                    break;
+    std::vector<vtkIdType> cells;
+    cells.reserve(activeCells.size());
 
-                } else {
-                    polys.push_back(next);
+    vtkIdType numCells = pd->GetNumberOfCells();
 
-                    cycle++;
-                }
+    // activeCells ist aufsteigend sortiert, da ScanCells nur anhängt
+    auto itr = deleted.begin();
 
-            }
+    for (vtkIdType cellId : activeCells) {
+        while (itr != deleted.end() && *itr < cellId) {
+            ++itr;
+        }
 
+        if (itr != deleted.end() && *itr == cellId) {
+            continue;
         }
 
-        // erzeugte polys hinzufügen
+        cells.push_back(cellId-(itr-deleted.begin()));
+    }
 
-        IdsType descIds;
+    activeCells.swap(cells);
 
-        for (itr9 = polys.begin(); itr9 != polys.end(); ++itr9) {
-            IdsType &p = *itr9;
+    pd->RemoveDeletedCells();
 
-            int num = p.size();
+    // alle gelöschten zellen müssen über DeleteCell gelöscht worden sein
+    assert(pd->GetNumberOfCells() == numCells-static_cast<vtkIdType>(deleted.size()));
 
-            vtkIdList *cell = vtkIdList::New();
-            cell->SetNumberOfIds(num);
+    numScannedCells = pd->GetNumberOfCells();
 
-            for (int i = 0; i < num; i++) {
-                cell->SetId(i, p[i]);
-            }
+    deleted.clear();
 
-            descIds.push_back(pd->InsertNextCell(VTK_POLYGON, cell));
+    linksValid = false;
+}
 
-            origCellIds->InsertNextValue(origId);
+void GeomContext::AddStats (StatsType &stats, const std::string &suffix) {
+    stats["locBuilds" + suffix] = locBuilds;
+    stats["locTime" + suffix] = locTime;
+    stats["linkBuilds" + suffix] = linkBuilds;
+    stats["linkTime" + suffix] = linkTime;
+    stats["activePts" + suffix] = activePts.size();
+    stats["activeCells" + suffix] = activeCells.size();
+}
 
-            cell->Delete();
-        }
+void vtkPolyDataBooleanFilter::GetActiveBounds (vtkPolyData *pd, PolyStripsType &polyStrips, double *bnds) {
 
-        pd->DeleteCell(polyInd);
+    // umgebung der geschnittenen polygone, nur dort wird nach punkten gesucht
 
-        // holes verarbeiten
+    bnds[0] = bnds[2] = bnds[4] = DBL_MAX;
+    bnds[1] = bnds[3] = bnds[5] = -DBL_MAX;
 
-        if (!holes.empty()) {
-            _Wrapper w(pd, descIds, origId);
+    double pt[3];
 
-            for (auto& hole : holes) {
-                w.Add(hole);
-            }
+    PolyStripsType::const_iterator itr;
 
-            w.MergeAll();
-        }
+    for (itr = polyStrips.begin(); itr != polyStrips.end(); ++itr) {
+        for (int id : itr->second.poly) {
+            pd->GetPoint(id, pt);
 
+            for (int i = 0; i < 3; i++) {
+                bnds[2*i] = std::min(bnds[2*i], pt[i]);
+                bnds[2*i+1] = std::max(bnds[2*i+1], pt[i]);
+            }
+        }
     }
 
-    pd->RemoveDeletedCells();
-    pd->BuildCells();
+    // der suchradius von FindPoints
+    for (int i = 0; i < 6; i++) {
+        bnds[i] += i%2 == 0 ? -1e-3 : 1e-3;
+    }
 
 }
 
@@ -1924,7 +2767,7 @@ void vtkPolyDataBooleanFilter::CollapseCaptPoints (vtkPolyData *vtkNotUsed(pd),
 }
 
 
-void vtkPolyDataBooleanFilter::RestoreOrigPoints (vtkPolyData *pd, PolyStripsType &polyStrips) {
+void vtkPolyDataBooleanFilter::RestoreOrigPoints (vtkPolyData *vtkNotUsed(pd), PolyStripsType &polyStrips, GeomContext &ctx) {
 
 #ifdef DEBUG
     std::cout << "RestoreOrigPoints()" << std::endl;
@@ -1944,37 +2787,32 @@ void vtkPolyDataBooleanFilter::RestoreOrigPoints (vtkPolyData *pd, PolyStripsTyp
         }
     }
 
-    vtkKdTreePointLocator *loc = vtkKdTreePointLocator::New();
-    loc->SetDataSet(pd);
-    loc->BuildLocator();
+    ctx.Begin();
 
     vtkIdList *pts = vtkIdList::New();
 
     std::vector<StripPtL>::const_iterator itr3;
 
     for (itr3 = ends.begin(); itr3 != ends.end(); ++itr3) {
-        FindPoints(loc, itr3->cutPt, pts);
+        ctx.FindPoints(itr3->cutPt, pts);
         int numPts = pts->GetNumberOfIds();
 
         for (int i = 0; i < numPts; i++) {
-            pd->GetPoints()->SetPoint(pts->GetId(i), itr3->pt);
+            ctx.SetPoint(pts->GetId(i), itr3->pt);
         }
     }
 
     pts->Delete();
 
-    loc->FreeSearchStructure();
-    loc->Delete();
-
 }
 
-void vtkPolyDataBooleanFilter::DisjoinPolys (vtkPolyData *pd, PolyStripsType &polyStrips) {
+void vtkPolyDataBooleanFilter::DisjoinPolys (vtkPolyData *pd, PolyStripsType &polyStrips, GeomContext &ctx) {
 
 #ifdef DEBUG
     std::cout << "DisjoinPolys()" << std::endl;
 #endif
 
-    pd->BuildLinks();
+    ctx.BuildLinks();
 
     std::set<StripPtL> ends;
 
@@ -1992,9 +2830,7 @@ void vtkPolyDataBooleanFilter::DisjoinPolys (vtkPolyData *pd, PolyStripsType &po
         }
     }
 
-    vtkKdTreePointLocator *loc = vtkKdTreePointLocator::New();
-    loc->SetDataSet(pd);
-    loc->BuildLocator();
+    ctx.Begin();
 
     vtkIdList *pts = vtkIdList::New();
     vtkIdList *cells = vtkIdList::New();
@@ -2002,16 +2838,16 @@ void vtkPolyDataBooleanFilter::DisjoinPolys (vtkPolyData *pd, PolyStripsType &po
     std::set<StripPtL>::const_iterator itr3;
 
     for (itr3 = ends.begin(); itr3 != ends.end(); ++itr3) {
-        FindPoints(loc, itr3->pt, pts);
+        ctx.FindPoints(itr3->pt, pts);
         int numPts = pts->GetNumberOfIds();
 
         for (int i = 0; i < numPts; i++) {
-            pd->GetPointCells(pts->GetId(i), cells);
+            ctx.GetPointCells(pts->GetId(i), cells);
             int numCells = cells->GetNumberOfIds();
 
             if (numCells > 1) {
                 for (int j = 0; j < numCells; j++) {
-                    pd->ReplaceCellPoint(cells->GetId(j), pts->GetId(i), pd->GetPoints()->InsertNextPoint(itr3->pt));
+                    ctx.ReplaceCellPoint(cells->GetId(j), pts->GetId(i), ctx.InsertNextPoint(itr3->pt));
                 }
             }
         }
@@ -2020,19 +2856,16 @@ void vtkPolyDataBooleanFilter::DisjoinPolys (vtkPolyData *pd, PolyStripsType &po
     cells->Delete();
     pts->Delete();
 
-    loc->FreeSearchStructure();
-    loc->Delete();
-
 }
 
-void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips) {
+void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips, GeomContext &ctx) {
 
 #ifdef DEBUG
     std::cout << "ResolveOverlaps()" << std::endl;
 #endif
 
     pd->BuildCells();
-    pd->BuildLinks();
+    ctx.BuildLinks();
 
     contLines->BuildLinks();
 
@@ -2052,9 +2885,7 @@ void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *co
         }
     }
 
-    vtkKdTreePointLocator *loc = vtkKdTreePointLocator::New();
-    loc->SetDataSet(pd);
-    loc->BuildLocator();
+    ctx.Begin();
 
     vtkIdList *ptsA = vtkIdList::New();
     vtkIdList *ptsB = vtkIdList::New();
@@ -2096,8 +2927,8 @@ void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *co
                 pd->GetPoint(itr4->f, ptA);
                 pd->GetPoint(itr4->g, ptB);
 
-                FindPoints(loc, ptA, ptsA);
-                FindPoints(loc, ptB, ptsB);
+                ctx.FindPoints(ptA, ptsA);
+                ctx.FindPoints(ptB, ptsB);
 
                 int numPtsA = ptsA->GetNumberOfIds();
                 int numPtsB = ptsB->GetNumberOfIds();
@@ -2107,7 +2938,7 @@ void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *co
                 cells->Reset();
 
                 for (int i = 0; i < numPtsA; i++) {
-                    pd->GetPointCells(ptsA->GetId(i), cells);
+                    ctx.GetPointCells(ptsA->GetId(i), cells);
                     for (int j = 0; j < cells->GetNumberOfIds(); j++) {
                         cellsA.push_back({static_cast<int>(ptsA->GetId(i)), static_cast<int>(cells->GetId(j))});
                     }
@@ -2116,7 +2947,7 @@ void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *co
                 cells->Reset();
 
                 for (int i = 0; i < numPtsB; i++) {
-                    pd->GetPointCells(ptsB->GetId(i), cells);
+                    ctx.GetPointCells(ptsB->GetId(i), cells);
                     for (int j = 0; j < cells->GetNumberOfIds(); j++) {
                         cellsB.push_back({static_cast<int>(ptsB->GetId(i)), static_cast<int>(cells->GetId(j))});
                     }
@@ -2170,9 +3001,6 @@ void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *co
     ptsB->Delete();
     ptsA->Delete();
 
-    loc->FreeSearchStructure();
-    loc->Delete();
-
     std::map<Pair, CountsType>::iterator itr4;
     CountsType::iterator itr5;
 
@@ -2193,19 +3021,19 @@ void vtkPolyDataBooleanFilter::ResolveOverlaps (vtkPolyData *pd, vtkIntArray *co
 
         for (itr5 = c.begin(); itr5 != c.end(); ++itr5) {
             if (itr5->second == 2) {
-                int i = pd->GetPoints()->InsertNextPoint(pt);
+                int i = ctx.InsertNextPoint(pt);
 
 #ifdef DEBUG
                 std::cout << "repl " << itr5->first << " -> " << i << std::endl;
 #endif
 
-                pd->ReplaceCellPoint(pair.g, itr5->first, i);
+                ctx.ReplaceCellPoint(pair.g, itr5->first, i);
             }
         }
     }
 }
 
-void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips) {
+void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips, GeomContext &ctx) {
 
 #ifdef DEBUG
     std::cout << "AddAdjacentPoints()" << std::endl;
@@ -2243,11 +3071,8 @@ void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *
     BType::iterator itr4;
     CType::iterator itr5;
 
-    pd->BuildLinks();
-
-    vtkKdTreePointLocator *loc = vtkKdTreePointLocator::New();
-    loc->SetDataSet(pd);
-    loc->BuildLocator();
+    ctx.BuildLinks();
+    ctx.Begin();
 
     typedef std::vector<Pair> DType;
 
@@ -2325,8 +3150,8 @@ void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *
                 vtkIdList *ptsA = vtkIdList::New();
                 vtkIdList *ptsB = vtkIdList::New();
 
-                FindPoints(loc, pts_.front().pt, ptsA);
-                FindPoints(loc, pts_.back().pt, ptsB);
+                ctx.FindPoints(pts_.front().pt, ptsA);
+                ctx.FindPoints(pts_.back().pt, ptsB);
 
                 int numPtsA = ptsA->GetNumberOfIds(),
                     numPtsB = ptsB->GetNumberOfIds();
@@ -2334,7 +3159,7 @@ void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *
                 DType polysA, polysB;
 
                 for (int j = 0; j < numPtsA; j++) {
-                    pd->GetPointCells(ptsA->GetId(j), cells);
+                    ctx.GetPointCells(ptsA->GetId(j), cells);
                     int numCells = cells->GetNumberOfIds();
                     for (int k = 0; k < numCells; k++) {
                         polysA.push_back(Pair(cells->GetId(k), ptsA->GetId(j)));
@@ -2342,7 +3167,7 @@ void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *
                 }
 
                 for (int j = 0; j < numPtsB; j++) {
-                    pd->GetPointCells(ptsB->GetId(j), cells);
+                    ctx.GetPointCells(ptsB->GetId(j), cells);
                     int numCells = cells->GetNumberOfIds();
                     for (int k = 0; k < numCells; k++) {
                         polysB.push_back(Pair(cells->GetId(k), ptsB->GetId(j)));
@@ -2371,17 +3196,15 @@ void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *
                                     // ursprüngliche kante
 
                                     for (itr5 = pts_.begin()+1; itr5 != pts_.end()-1; ++itr5) {
-                                        poly_->InsertNextId(pd->InsertNextLinkedPoint(itr5->pt, 1));
+                                        poly_->InsertNextId(ctx.InsertNextPoint(itr5->pt));
                                     }
 
                                 }
-
-                                pd->RemoveReferenceToCell(poly->GetId(j), itr7->f);
                             }
 
-                            pd->DeleteCell(itr7->f);
+                            ctx.DeleteCell(itr7->f);
 
-                            pd->InsertNextLinkedCell(VTK_POLYGON, poly_->GetNumberOfIds(), poly_->GetPointer(0));
+                            ctx.InsertNextCell(VTK_POLYGON, poly_->GetNumberOfIds(), poly_->GetPointer(0));
 
                             origCellIds->InsertNextValue(origCellIds->GetValue(itr7->f));
 
@@ -2403,25 +3226,20 @@ void vtkPolyDataBooleanFilter::AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *
 
     cells->Delete();
 
-    loc->FreeSearchStructure();
-    loc->Delete();
-
-    pd->RemoveDeletedCells();
+    ctx.RemoveDeletedCells();
 
 }
 
-void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &polyStrips) {
+void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &polyStrips, GeomContext &ctx) {
 
 #ifdef DEBUG
     std::cout << "MergePoints()" << std::endl;
 #endif
 
-    vtkKdTreePointLocator *loc = vtkKdTreePointLocator::New();
-    loc->SetDataSet(pd);
-    loc->BuildLocator();
+    ctx.Begin();
 
     // essenziell
-    pd->BuildLinks();
+    ctx.BuildLinks();
 
     PolyStripsType::iterator itr;
     StripsType::iterator itr2;
@@ -2442,14 +3260,14 @@ void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &pol
             StripPtR &s = strip.front(),
                 &e = strip.back();
 
-            FindPoints(loc, pStrips.pts[(strip.begin()+1)->ind].pt, pts);
+            ctx.FindPoints(pStrips.pts[(strip.begin()+1)->ind].pt, pts);
             int numPts = pts->GetNumberOfIds();
 
             for (int i = 0; i < numPts; i++) {
                 inds[s.ind].insert(pts->GetId(i));
             }
 
-            FindPoints(loc, pStrips.pts[(strip.end()-2)->ind].pt, pts);
+            ctx.FindPoints(pStrips.pts[(strip.end()-2)->ind].pt, pts);
             numPts = pts->GetNumberOfIds();
 
             for (int i = 0; i < numPts; i++) {
@@ -2489,7 +3307,7 @@ void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &pol
         double pt[3];
         contLines->GetPoint(itr3->first, pt);
 
-        FindPoints(loc, pt, pts);
+        ctx.FindPoints(pt, pts);
         int numPts = pts->GetNumberOfIds();
 
         assert(numPts > 0);
@@ -2498,7 +3316,7 @@ void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &pol
         std::cout << "pts=[";
         for (int i = 0; i < numPts; i++) {
             int ind = pts->GetId(i);
-            pd->GetPointCells(ind, polys);
+            ctx.GetPointCells(ind, polys);
             if (polys->GetNumberOfIds() > 0) {
                 std::cout << ind << " -> " << polys->GetId(0) << ", ";
             }
@@ -2509,7 +3327,7 @@ void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &pol
         for (int i = 0; i < numPts; i++) {
             int ind = pts->GetId(i);
 
-            pd->GetPointCells(ind, polys);
+            ctx.GetPointCells(ind, polys);
 
             if (polys->GetNumberOfIds() > 0) {
                 // sollte nur von einem verwendet werden
@@ -2633,8 +3451,7 @@ void vtkPolyDataBooleanFilter::MergePoints (vtkPolyData *pd, PolyStripsType &pol
     poly->Delete();
     polys->Delete();
 
-    loc->FreeSearchStructure();
-    loc->Delete();
+    ctx.InvalidateLinks();
 
 }
 
@@ -2857,81 +3674,218 @@ PolyPair GetEdgePolys (vtkPolyData *pd, vtkIdList *ptsA, vtkIdList *ptsB) {
 
 }
 
+void vtkPolyDataBooleanFilter::FilterCells (vtkPolyData *pd, RelationsType &rels, vtkPolyData *filterd, const std::vector<bool> *complete) {
+
+    // übernimmt nur die benötigten zellen, die punkte werden geteilt
+
+    const Rel skip = DecPolys ? Rel::ORIG : Rel::DEC;
+
+    vtkIntArray *origCellIds = vtkIntArray::SafeDownCast(pd->GetCellData()->GetScalars("OrigCellIds"));
+
+    vtkIdType i, numCells = pd->GetNumberOfCells();
+
+    filterd->SetPoints(pd->GetPoints());
+    filterd->GetPointData()->PassData(pd->GetPointData());
+
+    filterd->Allocate(numCells);
+
+    vtkCellData *cellData = filterd->GetCellData();
+    cellData->CopyAllocate(pd->GetCellData(), numCells);
+
+    vtkIdType num, *poly, cellId;
+
+    RelationsType::const_iterator itr;
+
+    for (i = 0; i < numCells; i++) {
+        itr = rels.find(i);
+
+        if ((itr != rels.end() && itr->second == skip) || pd->GetCellType(i) == VTK_EMPTY_CELL) {
+            continue;
+        }
+
+        if (complete != nullptr && !(*complete)[origCellIds->GetValue(i)]) {
+            continue;
+        }
+
+        pd->GetCellPoints(i, num, poly);
+
+        cellId = filterd->InsertNextCell(pd->GetCellType(i), num, poly);
+        cellData->CopyData(pd->GetCellData(), i, cellId);
+    }
+
+}
+
 void vtkPolyDataBooleanFilter::CombineRegions () {
 
 #ifdef DEBUG
     std::cout << "CombineRegions()" << std::endl;
 #endif
 
-    vtkPolyData *filterdA = vtkPolyData::New();
-    filterdA->DeepCopy(modPdA);
+    vtkPolyData *filterdA = vtkPolyData::New();
+    FilterCells(modPdA, relsA, filterdA);
+
+    vtkPolyData *filterdB = vtkPolyData::New();
+    FilterCells(modPdB, relsB, filterdB);
+
+    // ungenutzte punkte löschen
+    vtkCleanPolyData *cleanA = vtkCleanPolyData::New();
+    cleanA->PointMergingOff();
+    cleanA->SetInputData(filterdA);
+
+    vtkCleanPolyData *cleanB = vtkCleanPolyData::New();
+    cleanB->PointMergingOff();
+    cleanB->SetInputData(filterdB);
+
+    // regionen mit skalaren ausstatten
+    vtkPolyDataConnectivityFilter *cfA = vtkPolyDataConnectivityFilter::New();
+    cfA->SetExtractionModeToAllRegions();
+    cfA->ColorRegionsOn();
+    cfA->SetInputConnection(cleanA->GetOutputPort());
+
+    vtkPolyDataConnectivityFilter *cfB = vtkPolyDataConnectivityFilter::New();
+    cfB->SetExtractionModeToAllRegions();
+    cfB->ColorRegionsOn();
+    cfB->SetInputConnection(cleanB->GetOutputPort());
+
+    cfA->Update();
+    cfB->Update();
+
+    vtkPolyData *pdA = cfA->GetOutput();
+    vtkPolyData *pdB = cfB->GetOutput();
+
+#ifdef DEBUG
+    std::cout << "Exporting modPdA_9.vtk" << std::endl;
+    WriteVTK("modPdA_9.vtk", cfA->GetOutput());
+
+    std::cout << "Exporting modPdB_9.vtk" << std::endl;
+    WriteVTK("modPdB_9.vtk", cfB->GetOutput());
+#endif
+
+    vtkDataArray *scalarsA = pdA->GetPointData()->GetScalars();
+    vtkDataArray *scalarsB = pdB->GetPointData()->GetScalars();
+
+    std::map<int, int> locsA, locsB;
+
+    LocateRegions(contLines, pdA, pdB,
+        [scalarsA] (vtkIdType id) { return static_cast<int>(scalarsA->GetTuple1(id)); },
+        [scalarsB] (vtkIdType id) { return static_cast<int>(scalarsB->GetTuple1(id)); },
+        locsA, locsB);
+
+    // reale kombination der ermittelten regionen
+
+    int comb[] = {LOC_OUTSIDE, LOC_OUTSIDE};
+
+    if (OperMode == OPER_INTERSECTION) {
+        comb[0] = LOC_INSIDE;
+        comb[1] = LOC_INSIDE;
+    } else if (OperMode == OPER_DIFFERENCE) {
+        comb[1] = LOC_INSIDE;
+    } else if (OperMode == OPER_DIFFERENCE2) {
+        comb[0] = LOC_INSIDE;
+    }
+
+    int numA = cfA->GetNumberOfExtractedRegions(),
+        numB = cfB->GetNumberOfExtractedRegions();
+
+    cfA->SetExtractionModeToSpecifiedRegions();
+    cfB->SetExtractionModeToSpecifiedRegions();
+
+    std::map<int, int>::const_iterator itr;
+
+    for (itr = locsA.begin(); itr != locsA.end(); itr++) {
+        if (itr->second == comb[0]) {
+            cfA->AddSpecifiedRegion(itr->first);
+        }
+    }
+
+    for (itr = locsB.begin(); itr != locsB.end(); itr++) {
+        if (itr->second == comb[1]) {
+            cfB->AddSpecifiedRegion(itr->first);
+        }
+    }
+
+    // nicht beteiligte regionen hinzufügen
+
+    int i;
+
+    if (OperMode == OPER_UNION || OperMode == OPER_DIFFERENCE) {
+        for (i = 0; i < numA; i++) {
+            if (locsA.count(i) == 0) {
+                cfA->AddSpecifiedRegion(i);
+            }
+        }
+    }
+
+    if (OperMode == OPER_UNION || OperMode == OPER_DIFFERENCE2) {
+        for (i = 0; i < numB; i++) {
+            if (locsB.count(i) == 0) {
+                cfB->AddSpecifiedRegion(i);
+            }
+        }
+    }
+
+    // nach innen zeigende normalen umkehren
+
+    cfA->Update();
+    cfB->Update();
+
+    vtkPolyData *regsA = cfA->GetOutput();
+    vtkPolyData *regsB = cfB->GetOutput();
 
-    vtkPolyData *filterdB = vtkPolyData::New();
-    filterdB->DeepCopy(modPdB);
+    scalarsA = regsA->GetPointData()->GetScalars();
+    scalarsB = regsB->GetPointData()->GetScalars();
 
-    auto FilterCells = [&](vtkPolyData *pd, RelationsType &rels) -> void {
-        RelationsType::const_iterator itr;
-        for (itr = rels.begin(); itr != rels.end(); ++itr) {
-            if (itr->second == (DecPolys ? Rel::ORIG : Rel::DEC)) {
-                pd->DeleteCell(itr->first);
+    if (OperMode != OPER_INTERSECTION) {
+        if (comb[0] == LOC_INSIDE) {
+            for (int i = 0; i < regsA->GetNumberOfCells(); i++) {
+                if (locsA.count(scalarsA->GetTuple1(i)) == 1) {
+                    regsA->ReverseCell(i);
+                }
             }
         }
 
-        pd->RemoveDeletedCells();
-    };
+        if (comb[1] == LOC_INSIDE) {
+            for (int i = 0; i < regsB->GetNumberOfCells(); i++) {
+                if (locsB.count(scalarsB->GetTuple1(i)) == 1) {
+                    regsB->ReverseCell(i);
+                }
+            }
+        }
+    }
 
-    FilterCells(filterdA, relsA);
-    FilterCells(filterdB, relsB);
+    CombineOutputs(regsA, regsB, cellIdsA, cellIdsB);
 
-    // ungenutzte punkte löschen
-    vtkCleanPolyData *cleanA = vtkCleanPolyData::New();
-    cleanA->PointMergingOff();
-    cleanA->SetInputData(filterdA);
+    // aufräumen
 
-    vtkCleanPolyData *cleanB = vtkCleanPolyData::New();
-    cleanB->PointMergingOff();
-    cleanB->SetInputData(filterdB);
+    cfB->Delete();
+    cfA->Delete();
 
-    // regionen mit skalaren ausstatten
-    vtkPolyDataConnectivityFilter *cfA = vtkPolyDataConnectivityFilter::New();
-    cfA->SetExtractionModeToAllRegions();
-    cfA->ColorRegionsOn();
-    cfA->SetInputConnection(cleanA->GetOutputPort());
+    cleanB->Delete();
+    cleanA->Delete();
 
-    vtkPolyDataConnectivityFilter *cfB = vtkPolyDataConnectivityFilter::New();
-    cfB->SetExtractionModeToAllRegions();
-    cfB->ColorRegionsOn();
-    cfB->SetInputConnection(cleanB->GetOutputPort());
+    filterdB->Delete();
+    filterdA->Delete();
 
-    cfA->Update();
-    cfB->Update();
+}
 
-    vtkPolyData *pdA = cfA->GetOutput();
-    vtkPolyData *pdB = cfB->GetOutput();
+void vtkPolyDataBooleanFilter::LocateRegions (vtkPolyData *lines, vtkPolyData *pdA, vtkPolyData *pdB, const std::function<int (vtkIdType)> &regionA, const std::function<int (vtkIdType)> &regionB,
+    std::map<int, int> &locsA, std::map<int, int> &locsB, const std::vector<bool> *skipA, const std::vector<bool> *skipB) {
 
-#ifdef DEBUG
-    std::cout << "Exporting modPdA_9.vtk" << std::endl;
-    WriteVTK("modPdA_9.vtk", cfA->GetOutput());
+    // locators erstellen, die abfragen liegen alle auf den kontaktlinien
 
-    std::cout << "Exporting modPdB_9.vtk" << std::endl;
-    WriteVTK("modPdB_9.vtk", cfB->GetOutput());
-#endif
+    double bnds[6];
+    lines->GetBounds(bnds);
 
-    // locators erstellen
-    vtkKdTreePointLocator *plA = vtkKdTreePointLocator::New();
-    plA->SetDataSet(pdA);
-    plA->BuildLocator();
+    for (int i = 0; i < 6; i++) {
+        bnds[i] += i%2 == 0 ? -1e-3 : 1e-3;
+    }
 
-    vtkKdTreePointLocator *plB = vtkKdTreePointLocator::New();
-    plB->SetDataSet(pdB);
-    plB->BuildLocator();
+    SubLocator plA(pdA, bnds);
+    SubLocator plB(pdB, bnds);
 
     pdA->BuildLinks();
     pdB->BuildLinks();
 
-    vtkDataArray *scalarsA = pdA->GetPointData()->GetScalars();
-    vtkDataArray *scalarsB = pdB->GetPointData()->GetScalars();
-
     vtkIdList *line = vtkIdList::New();
 
     double ptA[3], ptB[3];
@@ -2942,21 +3896,35 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
     vtkIdList *fptsB = vtkIdList::New();
     vtkIdList *lptsB = vtkIdList::New();
 
-    std::map<int, int> locsA, locsB;
+    auto Skip = [] (vtkIdList *pts, const std::vector<bool> *skip) {
+        if (skip != nullptr) {
+            for (vtkIdType j = 0; j < pts->GetNumberOfIds(); j++) {
+                if ((*skip)[pts->GetId(j)]) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    };
 
-    for (int i = 0; i < contLines->GetNumberOfCells(); i++) {
+    for (int i = 0; i < lines->GetNumberOfCells(); i++) {
 
-        if (contLines->GetCellType(i) == VTK_EMPTY_CELL) {
+        if (lines->GetCellType(i) == VTK_EMPTY_CELL) {
             continue;
         }
 
-        contLines->GetCellPoints(i, line);
+        lines->GetCellPoints(i, line);
 
-        contLines->GetPoint(line->GetId(0), ptA);
-        contLines->GetPoint(line->GetId(1), ptB);
+        lines->GetPoint(line->GetId(0), ptA);
+        lines->GetPoint(line->GetId(1), ptB);
 
-        FindPoints(plA, ptA, fptsA);
-        FindPoints(plB, ptA, fptsB);
+        plA.FindPoints(ptA, fptsA);
+        plB.FindPoints(ptA, fptsB);
+
+        if (Skip(fptsA, skipA) || Skip(fptsB, skipB)) {
+            continue;
+        }
 
 #ifdef DEBUG
         std::cout << "line " << i << std::endl;
@@ -2967,13 +3935,13 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
         int notLocated = 0;
 
         for (int j = 0; j < fptsA->GetNumberOfIds(); j++) {
-            if (locsA.count(scalarsA->GetTuple1(fptsA->GetId(j))) == 0) {
+            if (locsA.count(regionA(fptsA->GetId(j))) == 0) {
                 notLocated++;
             }
         }
 
         for (int j = 0; j < fptsB->GetNumberOfIds(); j++) {
-            if (locsB.count(scalarsB->GetTuple1(fptsB->GetId(j))) == 0) {
+            if (locsB.count(regionB(fptsB->GetId(j))) == 0) {
                 notLocated++;
             }
         }
@@ -2984,8 +3952,12 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
 
 #endif
 
-        FindPoints(plA, ptB, lptsA);
-        FindPoints(plB, ptB, lptsB);
+        plA.FindPoints(ptB, lptsA);
+        plB.FindPoints(ptB, lptsB);
+
+        if (Skip(lptsA, skipA) || Skip(lptsB, skipB)) {
+            continue;
+        }
 
         PolyPair ppA = GetEdgePolys(pdA, fptsA, lptsA);
         PolyPair ppB = GetEdgePolys(pdB, fptsB, lptsB);
@@ -2996,11 +3968,11 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
         ppA.GetLoc(ppB.pA, OperMode);
         ppA.GetLoc(ppB.pB, OperMode);
 
-        int fsA = scalarsA->GetTuple1(ppA.pA.ptIdA);
-        int lsA = scalarsA->GetTuple1(ppA.pB.ptIdA);
+        int fsA = regionA(ppA.pA.ptIdA);
+        int lsA = regionA(ppA.pB.ptIdA);
 
-        int fsB = scalarsB->GetTuple1(ppB.pA.ptIdA);
-        int lsB = scalarsB->GetTuple1(ppB.pB.ptIdA);
+        int fsB = regionB(ppB.pA.ptIdA);
+        int lsB = regionB(ppB.pB.ptIdA);
 
 #ifdef DEBUG
         std::cout << "polyId " << ppA.pA.polyId << ", sA " << fsA << ", loc " << ppA.pA.loc << std::endl;
@@ -3042,87 +4014,9 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
 
     line->Delete();
 
-    // reale kombination der ermittelten regionen
-
-    int comb[] = {LOC_OUTSIDE, LOC_OUTSIDE};
-
-    if (OperMode == OPER_INTERSECTION) {
-        comb[0] = LOC_INSIDE;
-        comb[1] = LOC_INSIDE;
-    } else if (OperMode == OPER_DIFFERENCE) {
-        comb[1] = LOC_INSIDE;
-    } else if (OperMode == OPER_DIFFERENCE2) {
-        comb[0] = LOC_INSIDE;
-    }
-
-    int numA = cfA->GetNumberOfExtractedRegions(),
-        numB = cfB->GetNumberOfExtractedRegions();
-
-    cfA->SetExtractionModeToSpecifiedRegions();
-    cfB->SetExtractionModeToSpecifiedRegions();
-
-    std::map<int, int>::const_iterator itr;
-
-    for (itr = locsA.begin(); itr != locsA.end(); itr++) {
-        if (itr->second == comb[0]) {
-            cfA->AddSpecifiedRegion(itr->first);
-        }
-    }
-
-    for (itr = locsB.begin(); itr != locsB.end(); itr++) {
-        if (itr->second == comb[1]) {
-            cfB->AddSpecifiedRegion(itr->first);
-        }
-    }
-
-    // nicht beteiligte regionen hinzufügen
-
-    int i;
-
-    if (OperMode == OPER_UNION || OperMode == OPER_DIFFERENCE) {
-        for (i = 0; i < numA; i++) {
-            if (locsA.count(i) == 0) {
-                cfA->AddSpecifiedRegion(i);
-            }
-        }
-    }
-
-    if (OperMode == OPER_UNION || OperMode == OPER_DIFFERENCE2) {
-        for (i = 0; i < numB; i++) {
-            if (locsB.count(i) == 0) {
-                cfB->AddSpecifiedRegion(i);
-            }
-        }
-    }
-
-    // nach innen zeigende normalen umkehren
-
-    cfA->Update();
-    cfB->Update();
-
-    vtkPolyData *regsA = cfA->GetOutput();
-    vtkPolyData *regsB = cfB->GetOutput();
-
-    scalarsA = regsA->GetPointData()->GetScalars();
-    scalarsB = regsB->GetPointData()->GetScalars();
-
-    if (OperMode != OPER_INTERSECTION) {
-        if (comb[0] == LOC_INSIDE) {
-            for (int i = 0; i < regsA->GetNumberOfCells(); i++) {
-                if (locsA.count(scalarsA->GetTuple1(i)) == 1) {
-                    regsA->ReverseCell(i);
-                }
-            }
-        }
+}
 
-        if (comb[1] == LOC_INSIDE) {
-            for (int i = 0; i < regsB->GetNumberOfCells(); i++) {
-                if (locsB.count(scalarsB->GetTuple1(i)) == 1) {
-                    regsB->ReverseCell(i);
-                }
-            }
-        }
-    }
+void vtkPolyDataBooleanFilter::CombineOutputs (vtkPolyData *regsA, vtkPolyData *regsB, vtkIntArray *idsA, vtkIntArray *idsB) {
 
     // OrigCellIds und CellData
 
@@ -3142,7 +4036,7 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
     newCellDataB->CopyAllocate(cellDataB);
 
     for (int i = 0; i < regsA->GetNumberOfCells(); i++) {
-        int cellId = cellIdsA->GetValue(origCellIdsA->GetValue(i));
+        int cellId = idsA != nullptr ? idsA->GetValue(origCellIdsA->GetValue(i)) : origCellIdsA->GetValue(i);
 
         newOrigCellIdsA->InsertNextValue(cellId);
         newOrigCellIdsB->InsertNextValue(-1);
@@ -3151,7 +4045,7 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
     }
 
     for (int i = 0; i < regsB->GetNumberOfCells(); i++) {
-        int cellId = cellIdsB->GetValue(origCellIdsB->GetValue(i));
+        int cellId = idsB != nullptr ? idsB->GetValue(origCellIdsB->GetValue(i)) : origCellIdsB->GetValue(i);
 
         newOrigCellIdsB->InsertNextValue(cellId);
         newOrigCellIdsA->InsertNextValue(-1);
@@ -3207,21 +4101,6 @@ void vtkPolyDataBooleanFilter::CombineRegions () {
     newOrigCellIdsB->Delete();
     newOrigCellIdsA->Delete();
 
-    plB->FreeSearchStructure();
-    plB->Delete();
-
-    plA->FreeSearchStructure();
-    plA->Delete();
-
-    cfB->Delete();
-    cfA->Delete();
-
-    cleanB->Delete();
-    cleanA->Delete();
-
-    filterdB->Delete();
-    filterdA->Delete();
-
 }
 
 
@@ -3231,40 +4110,29 @@ void vtkPolyDataBooleanFilter::MergeRegions () {
     std::cout << "MergeRegions()" << std::endl;
 #endif
 
+    vtkPolyData *pdA = vtkPolyData::New();
+    FilterCells(modPdA, relsA, pdA);
+
+    vtkPolyData *pdB = vtkPolyData::New();
+    FilterCells(modPdB, relsB, pdB);
+
+    // vtkAppendPolyData ordnet die aktiven scalars nach ihrer rolle zu, nicht nach dem namen
+    // daher eigene kopien, die OrigCellIds werden nach dem anhängen entfernt
+
     vtkIntArray *origCellIdsA = vtkIntArray::New();
-    origCellIdsA->DeepCopy(modPdA->GetCellData()->GetScalars("OrigCellIds"));
+    origCellIdsA->DeepCopy(pdA->GetCellData()->GetScalars("OrigCellIds"));
     origCellIdsA->SetName("OrigCellIdsA");
 
     vtkIntArray *origCellIdsB = vtkIntArray::New();
-    origCellIdsB->DeepCopy(modPdB->GetCellData()->GetScalars("OrigCellIds"));
+    origCellIdsB->DeepCopy(pdB->GetCellData()->GetScalars("OrigCellIds"));
     origCellIdsB->SetName("OrigCellIdsB");
 
-    vtkPolyData *pdA = vtkPolyData::New();
-    pdA->DeepCopy(modPdA);
-
-    vtkPolyData *pdB = vtkPolyData::New();
-    pdB->DeepCopy(modPdB);
-
     pdA->GetCellData()->AddArray(origCellIdsA);
     pdB->GetCellData()->AddArray(origCellIdsB);
 
     origCellIdsA->Delete();
     origCellIdsB->Delete();
 
-    auto FilterCells = [&](vtkPolyData *pd, RelationsType &rels) -> void {
-        RelationsType::const_iterator itr;
-        for (itr = rels.begin(); itr != rels.end(); ++itr) {
-            if (itr->second == (DecPolys ? Rel::ORIG : Rel::DEC)) {
-                pd->DeleteCell(itr->first);
-            }
-        }
-
-        pd->RemoveDeletedCells();
-    };
-
-    FilterCells(pdA, relsA);
-    FilterCells(pdB, relsB);
-
     vtkIntArray *padIdsA = vtkIntArray::New();
     vtkIntArray *padIdsB = vtkIntArray::New();
 
@@ -3430,6 +4298,21 @@ void vtkPolyDataBooleanFilter::DecPolys_ (vtkPolyData *pd, InvolvedType &involve
         }
     }
 
+    // die zerlegungen sind unabhängig voneinander und laufen parallel
+    // die neuen zellen werden danach in der ursprünglichen reihenfolge angehängt
+
+    struct Job {
+        int cellId, origId;
+        IdsType ptIds;
+        PolyType poly;
+        DecResType decs;
+        std::string err;
+    };
+
+    std::vector<Job> jobs;
+
+    vtkIdList *cell = vtkIdList::New();
+
     for (int i = 0; i < cells->GetNumberOfIds(); i++) {
 
         int cellId = cells->GetId(i),
@@ -3443,82 +4326,186 @@ void vtkPolyDataBooleanFilter::DecPolys_ (vtkPolyData *pd, InvolvedType &involve
         //     continue;
         // }
 
-        auto _ps = (pd == modPdA ? polyStripsA : polyStripsB).at(origId);
-
-        vtkIdList *cell = vtkIdList::New();
+#ifdef DEBUG
+        // nach dem laden eines abbilds sind die strips leer
+        const PolyStripsType &polyStrips = pd == modPdA ? polyStripsA : polyStripsB;
+        assert(polyStrips.empty() || polyStrips.count(origId) == 1);
+#endif
 
         pd->GetCellPoints(cellId, cell);
 
-        Base base(pdPts, cell);
-
         int numPts = cell->GetNumberOfIds();
 
         if (numPts > 3) {
+            Base base(pdPts, cell);
 
-            IdsType ptIds;
+            Job job;
+
+            job.cellId = cellId;
+            job.origId = origId;
 
             for (int k = 0; k < numPts; k++) {
-                ptIds.push_back(cell->GetId(k));
+                job.ptIds.push_back(cell->GetId(k));
             }
 
-            std::reverse(ptIds.begin(), ptIds.end());
-
-            PolyType poly;
+            std::reverse(job.ptIds.begin(), job.ptIds.end());
 
             int j = 0;
 
-            for (int id : ptIds) {
+            for (int id : job.ptIds) {
                 double pt[3],
                     _pt[2];
 
                 pd->GetPoint(id, pt);
                 Transform(pt, _pt, base);
 
-                poly.push_back({_pt, j++});
+                job.poly.push_back({_pt, j++});
             }
 
-            assert(TestCW(poly));
+            assert(TestCW(job.poly));
 
-            vtkIdList *newCell = vtkIdList::New();
+            jobs.push_back(std::move(job));
+        }
+    }
 
-            try {
+    cell->Delete();
+    cells->Delete();
 
-                Decomposer d(poly);
+    const bool fast = DecMode == DEC_FAST;
 
-                DecResType decs;
-                d.GetDecomposed(decs);
+    // jeder thread prüft den abbruch, der fortschritt wird von dem thread gemeldet, der gerade den mutex bekommt
+    // so gibt es auch dann einen fortschritt, wenn der aufrufende thread keinen abschnitt bearbeitet
 
-                for (auto& dec : decs) {
-                    newCell->Reset();
+    std::mutex progMutex;
 
-                    std::reverse(dec.begin(), dec.end());
+    std::atomic<vtkIdType> done(0);
+    std::atomic<bool> stop(false);
 
-                    for (int id : dec) {
-                        newCell->InsertNextId(ptIds[id]);
-                    }
+    const vtkIdType numJobs = jobs.size();
 
-                    int newId = pd->InsertNextCell(VTK_POLYGON, newCell);
-                    origCellIds->InsertNextValue(origId);
+    auto Decompose = [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType i = first; i < last && !stop; i++) {
+            Job &job = jobs[i];
 
-                    rels[newId] = Rel::DEC;
+            // GetAbortExecute liest nur ein member
+            if (GetAbortExecute()) {
+                stop = true;
+                break;
+            }
 
+            {
+                std::unique_lock<std::mutex> lock(progMutex, std::try_to_lock);
+
+                if (lock.owns_lock() && StepProgress(pd, done, numJobs)) {
+                    stop = true;
+                    break;
                 }
+            }
 
-                rels[cellId] = Rel::ORIG;
+            try {
+                if (fast) {
+                    HmDecomposer d(job.poly);
+                    d.GetDecomposed(job.decs);
+                } else {
+                    Decomposer d(job.poly);
+                    d.GetDecomposed(job.decs);
+                }
 
             } catch (const std::exception &e) {
-                std::cerr << e.what()
-                    << " on " << GetAbsolutePath(poly)
-                    << std::endl;
+                job.decs.clear();
+                job.err = e.what();
             }
 
-            newCell->Delete();
+            done++;
+        }
+    };
+
+    vtkSMPTools::For(0, numJobs, Decompose);
+
+    if (stop) {
+        return;
+    }
+
+    UpdateProgress(progStart+(progEnd-progStart)*(pd == modPdA ? .5 : 1));
+
+    vtkIdList *newCell = vtkIdList::New();
 
+    for (Job &job : jobs) {
+        if (!job.err.empty()) {
+            std::cerr << job.err
+                << " on " << GetAbsolutePath(job.poly)
+                << std::endl;
+
+            continue;
         }
 
-        cell->Delete();
+        for (auto& dec : job.decs) {
+            newCell->Reset();
+
+            std::reverse(dec.begin(), dec.end());
+
+            for (int id : dec) {
+                newCell->InsertNextId(job.ptIds[id]);
+            }
+
+            int newId = pd->InsertNextCell(VTK_POLYGON, newCell);
+            origCellIds->InsertNextValue(job.origId);
+
+            rels[newId] = Rel::DEC;
+
+        }
+
+        rels[job.cellId] = Rel::ORIG;
     }
 
-    cells->Delete();
+    newCell->Delete();
+
+}
+
+void vtkPolyDataBooleanFilter::RevertDecomposition (vtkPolyData *pd, vtkIdType numCells, RelationsType &rels) {
+
+    // entfernt die von DecPolys_ angehängten zellen
+
+    if (rels.empty()) {
+        return;
+    }
+
+    vtkCellArray *polys = vtkCellArray::New();
+
+    IdsType deleted;
+
+    vtkIdType i, num, *poly;
+
+    for (i = 0; i < numCells; i++) {
+        pd->GetCellPoints(i, num, poly);
+        polys->InsertNextCell(num, poly);
+
+        if (pd->GetCellType(i) == VTK_EMPTY_CELL) {
+            deleted.push_back(i);
+        }
+    }
+
+    pd->SetPolys(polys);
+    polys->Delete();
+
+    pd->DeleteCells();
+    pd->BuildCells();
+
+    // gelöschte zellen bleiben gelöscht
+    for (auto id : deleted) {
+        pd->DeleteCell(id);
+    }
+
+    vtkCellData *cellData = pd->GetCellData();
+
+    for (i = 0; i < cellData->GetNumberOfArrays(); i++) {
+        vtkAbstractArray *arr = cellData->GetAbstractArray(i);
+
+        if (arr->GetNumberOfTuples() > numCells) {
+            arr->SetNumberOfTuples(numCells);
+        }
+    }
+
+    rels.clear();
 
 }
@@ -23,11 +23,20 @@ limitations under the License.
 #include <set>
 #include <utility>
 #include <iostream>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkKdTreePointLocator.h>
 
 #include "Utilities.h"
+#include "Profile.h"
+#include "Tiles.h"
 
 #define LOC_NONE 0
 #define LOC_INSIDE 1
@@ -38,6 +47,9 @@ limitations under the License.
 #define OPER_DIFFERENCE 2
 #define OPER_DIFFERENCE2 3
 
+#define DEC_MINIMAL 0
+#define DEC_FAST 1
+
 #define CAPT_NOT 0
 #define CAPT_EDGE 1
 #define CAPT_A 2
@@ -219,6 +231,102 @@ enum class Rel {
 
 typedef std::map<int, Rel> RelationsType;
 
+typedef std::map<std::string, double> StatsType;
+
+enum class CutResult {
+    OK,
+    NO_CONTACT,
+    FAILED,
+    ABORTED
+};
+
+// misst einen abschnitt von ProcessRequest, die dauer landet unter time<name> in stats
+// jeder abschnitt läuft höchstens einmal je aufruf, der wert ersetzt den der vorigen berechnung
+// im gekachelten modus werden die werte der kacheln summiert
+// mit VTKBOOL_PROFILE zusätzlich die allokationen (allocs<name>, bytes<name>) und der rss am ende (rss<name>)
+class StageTimer {
+    StatsType &stats;
+    std::string name;
+    std::chrono::steady_clock::time_point start;
+#ifdef VTKBOOL_PROFILE
+    AllocCounts counts;
+#endif
+public:
+    StageTimer (StatsType &stats, const std::string &name) : stats(stats), name(name) {
+#ifdef VTKBOOL_PROFILE
+        counts = GetAllocCounts();
+#endif
+        start = std::chrono::steady_clock::now();
+    }
+    ~StageTimer () {
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+#ifdef VTKBOOL_PROFILE
+        AllocCounts now = GetAllocCounts();
+
+        stats["allocs" + name] = now.allocs-counts.allocs;
+        stats["bytes" + name] = now.bytes-counts.bytes;
+        stats["rss" + name] = GetCurrentRss();
+#endif
+
+        stats["time" + name] = time;
+    }
+};
+
+class GeomContext {
+    vtkPolyData *pd;
+    double bnds[6];
+
+    // die punkte und zellen innerhalb von bnds, nur sie werden von locator und links erfasst
+    // durchsucht werden jeweils nur die seit dem letzten mal angehängten
+    std::vector<vtkIdType> activePts, activeCells;
+    vtkIdType numScannedPts, numScannedCells;
+
+    void ScanPoints ();
+    void ScanCells ();
+
+    // der locator enthält die punkte bis numBuilt, die folgenden werden linear durchsucht
+    std::unique_ptr<SubLocator> loc;
+    vtkIdType numBuilt, numVisible;
+    bool locStale;
+
+    // nur für die punkte der aktiven zellen
+    std::unordered_map<vtkIdType, std::vector<vtkIdType>> links;
+    bool linksValid;
+
+    // die mit DeleteCell gelöschten zellen, für RemoveDeletedCells
+    std::vector<vtkIdType> deleted;
+
+    int locBuilds, linkBuilds;
+    double locTime, linkTime;
+
+public:
+    GeomContext (vtkPolyData *pd, const double *bnds);
+
+    // wie ein neu erstellter locator, später eingefügte punkte werden nicht gefunden
+    void Begin ();
+    void FindPoints (const double *pt, vtkIdList *pts, double tol = 1e-6);
+
+    void SetPoint (vtkIdType id, const double *pt);
+
+    void BuildLinks (bool force = false);
+    void InvalidateLinks () { linksValid = false; }
+
+    // wie vtkPolyData::GetPointCells, aber nur für punkte innerhalb von bnds
+    void GetPointCells (vtkIdType id, vtkIdList *cells);
+
+    // halten die links aktuell
+    vtkIdType InsertNextPoint (const double *pt);
+    void ReplaceCellPoint (vtkIdType cellId, vtkIdType oldId, vtkIdType newId);
+    vtkIdType InsertNextCell (int type, vtkIdType num, const vtkIdType *pts);
+    void DeleteCell (vtkIdType cellId);
+
+    // nummeriert die aktiven zellen wie pd->RemoveDeletedCells um, danach sind die links ungültig
+    void RemoveDeletedCells ();
+
+    void AddStats (StatsType &stats, const std::string &suffix);
+};
+
 class VTK_EXPORT vtkPolyDataBooleanFilter : public vtkPolyDataAlgorithm {
     vtkPolyData *resultA, *resultB, *contLines;
     vtkPolyData *modPdA, *modPdB;
@@ -233,24 +341,77 @@ class VTK_EXPORT vtkPolyDataBooleanFilter : public vtkPolyDataAlgorithm {
 
     RelationsType relsA, relsB;
 
+    // anzahl der zellen vor der zerlegung
+    vtkIdType numCellsA, numCellsB;
+
     void GetStripPoints (vtkPolyData *pd, vtkIntArray *sources, PStrips &pStrips, IdsType &lines);
-    bool GetPolyStrips (vtkPolyData *pd, vtkIntArray *conts, vtkIntArray *sources, PolyStripsType &polyStrips);
+    // ohne complete werden alle polygone zerlegt, sonst nur die vollständigen
+    bool GetPolyStrips (vtkPolyData *pd, vtkIntArray *conts, vtkIntArray *sources, PolyStripsType &polyStrips, const std::vector<bool> *complete = nullptr);
     void RemoveDuplicates (IdsType &lines);
     void CompleteStrips (PStrips &pStrips);
     bool HasArea (StripType &strip);
+    void GetActiveBounds (vtkPolyData *pd, PolyStripsType &polyStrips, double *bnds);
     void CollapseCaptPoints (vtkPolyData *pd, PolyStripsType &polyStrips);
     void CutCells (vtkPolyData *pd, PolyStripsType &polyStrips);
-    void RestoreOrigPoints (vtkPolyData *pd, PolyStripsType &polyStrips);
-    void DisjoinPolys (vtkPolyData *pd, PolyStripsType &polyStrips);
-    void ResolveOverlaps (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips);
-    void AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips);
-    void MergePoints (vtkPolyData *pd, PolyStripsType &polyStrips);
+    void RestoreOrigPoints (vtkPolyData *pd, PolyStripsType &polyStrips, GeomContext &ctx);
+    void DisjoinPolys (vtkPolyData *pd, PolyStripsType &polyStrips, GeomContext &ctx);
+    void ResolveOverlaps (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips, GeomContext &ctx);
+    void AddAdjacentPoints (vtkPolyData *pd, vtkIntArray *conts, PolyStripsType &polyStrips, GeomContext &ctx);
+    void MergePoints (vtkPolyData *pd, PolyStripsType &polyStrips, GeomContext &ctx);
     void DecPolys_ (vtkPolyData *pd, InvolvedType &involved, RelationsType &rels);
+    void RevertDecomposition (vtkPolyData *pd, vtkIdType numCells, RelationsType &rels);
+    void FilterCells (vtkPolyData *pd, RelationsType &rels, vtkPolyData *filterd, const std::vector<bool> *complete = nullptr);
     void CombineRegions ();
     void MergeRegions ();
 
+    // die schritte vom kontakt bis zu MergePoints, complete wie bei GetPolyStrips
+    CutResult ComputeCuts (vtkPolyData *inA, vtkPolyData *inB, const std::vector<bool> *completeA = nullptr, const std::vector<bool> *completeB = nullptr);
+
+    // ermittelt die lage der regionen an lines, region liefert die region eines punktes
+    // linien an den punkten in skipA und skipB werden übergangen
+    void LocateRegions (vtkPolyData *lines, vtkPolyData *pdA, vtkPolyData *pdB, const std::function<int (vtkIdType)> &regionA, const std::function<int (vtkIdType)> &regionB,
+        std::map<int, int> &locsA, std::map<int, int> &locsB, const std::vector<bool> *skipA = nullptr, const std::vector<bool> *skipB = nullptr);
+
+    // setzt die ausgewählten regionen zum ergebnis zusammen, ids bildet ihre OrigCellIds auf die zellen der eingaben ab (nullptr, wenn es diese schon sind)
+    void CombineOutputs (vtkPolyData *regsA, vtkPolyData *regsB, vtkIntArray *idsA, vtkIntArray *idsB);
+
+    double TileSize;
+
+    int ProcessTiles (vtkPolyData *inA, vtkPolyData *inB);
+
+    // übernimmt die regionen und kontaktlinien der zuständigen zellen einer geschnittenen kachel
+    void CollectTile (const TilePart &partA, const TilePart &partB, TiledMesh &meshA, TiledMesh &meshB,
+        vtkPoints *linePts, vtkCellArray *lineCells, vtkIntArray *linesA, vtkIntArray *linesB);
+
+    void FinishStats ();
+
     int OperMode;
     bool MergeRegs, DecPolys;
+    int DecMode;
+    double SnapResolution;
+
+    StatsType stats;
+
+    // fortschritt innerhalb des aktuellen abschnitts
+    double progStart, progEnd;
+    unsigned int progCount;
+
+    // der anteil der aktuellen kachel am gesamten fortschritt
+    double progOffset, progScale;
+
+    void SetProgressRange (double start, double end);
+    bool StepProgress (vtkPolyData *pd, vtkIdType i, vtkIdType n);
+    void ForwardProgress (vtkObject *caller, unsigned long event, void *data);
+
+    // verwirft die teilergebnisse nach einem abbruch
+    int Abort ();
+
+    char *SnapshotDir;
+
+    // der dateiname enthält den hash der eingaben
+    std::string GetSnapshotFile (vtkPolyData *pdA, vtkPolyData *pdB, std::uint64_t &hash);
+    bool LoadSnapshot (const std::string &file, std::uint64_t hash);
+    void SaveSnapshot (const std::string &file, std::uint64_t hash);
 
 public:
     vtkTypeMacro(vtkPolyDataBooleanFilter, vtkPolyDataAlgorithm);
@@ -272,6 +433,62 @@ public:
     vtkGetMacro(DecPolys, bool);
     vtkBooleanMacro(DecPolys, bool);
 
+    // DEC_FAST zerlegt nach Hertel und Mehlhorn, liefert mehr, aber schneller berechnete polygone
+    void SetDecMode (int mode) {
+        mode = std::max(DEC_MINIMAL, std::min(mode, DEC_FAST));
+
+        if (mode != DecMode) {
+            DecMode = mode;
+
+            // die schnitte bleiben erhalten, nur die zerlegung wird wiederholt
+            RevertDecomposition(modPdA, numCellsA, relsA);
+            RevertDecomposition(modPdB, numCellsB, relsB);
+
+            Modified();
+        }
+    }
+    vtkGetMacro(DecMode, int);
+
+    void SetDecModeToMinimal () { SetDecMode(DEC_MINIMAL); }
+    void SetDecModeToFast () { SetDecMode(DEC_FAST); }
+
+    // rastet die punkte beider eingaben auf ein gitter ein (0 schaltet es ab)
+    void SetSnapResolution (double res) {
+        if (res != SnapResolution) {
+            SnapResolution = res;
+
+            // erzwingt die neuberechnung
+            timePdA = 0;
+            timePdB = 0;
+
+            Modified();
+        }
+    }
+    vtkGetMacro(SnapResolution, double);
+
+    // kantenlänge der kacheln im gekachelten modus (0 schaltet ihn ab)
+    // es wird immer vollständig neu berechnet, die schnitte der kacheln werden nicht aufbewahrt
+    void SetTileSize (double size) {
+        if (size != TileSize) {
+            TileSize = size;
+
+            // erzwingt die neuberechnung
+            timePdA = 0;
+            timePdB = 0;
+
+            Modified();
+        }
+    }
+    vtkGetMacro(TileSize, double);
+
+    // legt den zustand vor der zerlegung in diesem verzeichnis ab
+    // eine spätere berechnung derselben eingaben, auch in einem anderen prozess, beginnt dann bei der zerlegung
+    vtkSetStringMacro(SnapshotDir);
+    vtkGetStringMacro(SnapshotDir);
+
+    // zähler und zeiten der letzten berechnung
+    const StatsType& GetStats () { return stats; }
+
 protected:
     vtkPolyDataBooleanFilter ();
     ~vtkPolyDataBooleanFilter ();
@@ -43,6 +43,7 @@ limitations under the License.
 
 #include "vtkPolyDataContactFilter.h"
 #include "Utilities.h"
+#include "Predicates.h"
 
 // #undef DEBUG
 
@@ -111,13 +112,10 @@ int vtkPolyDataContactFilter::ProcessRequest (vtkInformation *request, vtkInform
         // durchführung der aufgabe
 
         pdA = vtkPolyData::New();
-        pdA->DeepCopy(_pdA);
-
         pdB = vtkPolyData::New();
-        pdB->DeepCopy(_pdB);
 
-        PreparePolyData(pdA);
-        PreparePolyData(pdB);
+        PreparePolyData(_pdA, pdA);
+        PreparePolyData(_pdB, pdB);
 
         if (pdA->GetNumberOfCells() == 0 || pdB->GetNumberOfCells() == 0) {
             vtkErrorMacro("One of the inputs does not contain any supported cells.");
@@ -125,6 +123,32 @@ int vtkPolyDataContactFilter::ProcessRequest (vtkInformation *request, vtkInform
             return 1;
         }
 
+        UpdateProgress(.1);
+
+        // die zellen von pdA, die die bounds von pdB berühren, werden ungefähr alle besucht
+
+        vtkIdType numCellsA = pdA->GetNumberOfCells();
+
+        double bndsB[6], bnds[6];
+        pdB->GetBounds(bndsB);
+
+        numCandsA = 0;
+
+        for (vtkIdType i = 0; i < numCellsA; i++) {
+            pdA->GetCellBounds(i, bnds);
+
+            if (bnds[0] <= bndsB[1] && bnds[1] >= bndsB[0]
+                && bnds[2] <= bndsB[3] && bnds[3] >= bndsB[2]
+                && bnds[4] <= bndsB[5] && bnds[5] >= bndsB[4]) {
+
+                numCandsA++;
+            }
+        }
+
+        visitedA.assign(numCellsA, 0);
+        numVisitedA = 0;
+        numCalls = 0;
+
         // anlegen der obb-trees
 
         vtkOBBTree *obbA = vtkOBBTree::New();
@@ -132,15 +156,35 @@ int vtkPolyDataContactFilter::ProcessRequest (vtkInformation *request, vtkInform
         obbA->SetNumberOfCellsPerNode(1);
         obbA->BuildLocator();
 
+        UpdateProgress(.2);
+
         vtkOBBTree *obbB = vtkOBBTree::New();
         obbB->SetDataSet(pdB);
         obbB->SetNumberOfCellsPerNode(1);
         obbB->BuildLocator();
 
+        UpdateProgress(.3);
+
         vtkMatrix4x4 *mat = vtkMatrix4x4::New();
 
         obbA->IntersectWithOBBTree(obbB, mat, InterOBBNodes, this);
 
+        visitedA.clear();
+        visitedA.shrink_to_fit();
+
+        if (GetAbortExecute()) {
+            mat->Delete();
+            obbB->Delete();
+            obbA->Delete();
+
+            pdB->Delete();
+            pdA->Delete();
+
+            return 1;
+        }
+
+        UpdateProgress(.9);
+
         contLines->GetCellData()->AddArray(contA);
         contLines->GetCellData()->AddArray(contB);
 
@@ -153,11 +197,11 @@ int vtkPolyDataContactFilter::ProcessRequest (vtkInformation *request, vtkInform
         clean->SetAbsoluteTolerance(1e-5);
         clean->Update();
 
-        resultA->DeepCopy(clean->GetOutput());
+        resultA->ShallowCopy(clean->GetOutput());
 
-        vtkIdType i, numCellsA = resultA->GetNumberOfCells();
+        vtkIdType i, numLines = resultA->GetNumberOfCells();
 
-        for (i = 0; i < numCellsA; i++) {
+        for (i = 0; i < numLines; i++) {
             if (resultA->GetCellType(i) != VTK_LINE) {
                 resultA->DeleteCell(i);
             }
@@ -172,8 +216,9 @@ int vtkPolyDataContactFilter::ProcessRequest (vtkInformation *request, vtkInform
         obbB->Delete();
         obbA->Delete();
 
-        resultB->DeepCopy(pdA);
-        resultC->DeepCopy(pdB);
+        // pdA und pdB werden nicht mehr gebraucht
+        resultB->ShallowCopy(pdA);
+        resultC->ShallowCopy(pdB);
 
         pdB->Delete();
         pdA->Delete();
@@ -184,32 +229,31 @@ int vtkPolyDataContactFilter::ProcessRequest (vtkInformation *request, vtkInform
 
 }
 
-void vtkPolyDataContactFilter::PreparePolyData (vtkPolyData *pd) {
+void vtkPolyDataContactFilter::PreparePolyData (vtkPolyData *in, vtkPolyData *pd) {
 
-    pd->GetCellData()->Initialize();
-    pd->GetPointData()->Initialize();
+    // die punkte werden geteilt, kopiert werden nur die polygone und die zerlegten streifen
+    // die ids der zellen bleiben dieselben wie bei einer kopie, aus der die übrigen zellen gelöscht wurden
 
-    vtkIdType i, numCells = pd->GetNumberOfCells();
+    pd->SetPoints(in->GetPoints());
 
+    vtkCellArray *polys = vtkCellArray::New();
     vtkIntArray *cellIds = vtkIntArray::New();
-    vtkIntArray *stripIds = vtkIntArray::New();
 
-    for (i = 0; i < numCells; i++) {
-        cellIds->InsertNextValue(i);
+    vtkIdType n;
+    vtkIdType *pts;
+
+    vtkIdType i = in->GetNumberOfVerts()+in->GetNumberOfLines();
 
-        if (pd->GetCellType(i) == VTK_TRIANGLE_STRIP) {
-            stripIds->InsertNextValue(i);
-        }
+    vtkCellArray *_polys = in->GetPolys();
+
+    for (_polys->InitTraversal(); _polys->GetNextCell(n, pts);) {
+        polys->InsertNextCell(n, pts);
+        cellIds->InsertNextValue(i++);
     }
 
     vtkCellArray *cells = vtkCellArray::New();
 
-    vtkCellArray *strips = pd->GetStrips();
-
-    vtkIdType n;
-    vtkIdType *pts;
-
-    i = 0;
+    vtkCellArray *strips = in->GetStrips();
 
     for (strips->InitTraversal(); strips->GetNextCell(n, pts);) {
         cells->Reset();
@@ -218,10 +262,8 @@ void vtkPolyDataContactFilter::PreparePolyData (vtkPolyData *pd) {
 
         for (cells->InitTraversal(); cells->GetNextCell(n, pts);) {
             if (pts[0] != pts[1] && pts[1] != pts[2] && pts[2] != pts[0]) {
-                pd->InsertNextCell(VTK_TRIANGLE, n, pts);
-                cellIds->InsertNextValue(stripIds->GetValue(i));
-
-                numCells++;
+                polys->InsertNextCell(n, pts);
+                cellIds->InsertNextValue(i);
             }
 
         }
@@ -230,29 +272,18 @@ void vtkPolyDataContactFilter::PreparePolyData (vtkPolyData *pd) {
 
     }
 
-    int type;
-    for (i = 0; i < numCells; i++) {
-        type = pd->GetCellType(i);
-
-        if (type != VTK_POLYGON && type != VTK_QUAD && type != VTK_TRIANGLE) {
-            pd->DeleteCell(i);
-        }
-
-    }
-
     cellIds->SetName("OrigCellIds");
 
+    pd->SetPolys(polys);
     pd->GetCellData()->SetScalars(cellIds);
 
     cells->Delete();
-    stripIds->Delete();
     cellIds->Delete();
-
-    pd->RemoveDeletedCells();
+    polys->Delete();
 
 }
 
-void vtkPolyDataContactFilter::InterEdgeLine (InterPtsType &interPts, const double *eA, const double *eB, const double *r, const double *ptA) {
+void vtkPolyDataContactFilter::InterEdgeLine (InterPtsType &interPts, const double *eA, const double *eB, const double *r, const double *ptA, const int *sides) {
 
     double ptB[3];
     vtkMath::Add(ptA, r, ptB);
@@ -266,6 +297,50 @@ void vtkPolyDataContactFilter::InterEdgeLine (InterPtsType &interPts, const doub
     double p[3];
     vtkMath::Subtract(eA, ptA, p);
 
+    if (sides != nullptr) {
+        // die lage der endpunkte zur anderen ebene ist exakt bekannt
+
+        if (sides[0] != 0 && sides[0] == sides[1]) {
+            return;
+        }
+
+        // die kante muss wie unten in einer ebene mit der schnittgeraden liegen
+        if (std::abs(vtkMath::Determinant3x3(r, e, p)) >= 1e-4) {
+            return;
+        }
+
+        double q[3];
+        vtkMath::Subtract(eB, ptA, q);
+
+        double dotA = vtkMath::Dot(p, r),
+            dotB = vtkMath::Dot(q, r);
+
+        if (sides[0] == 0 && sides[1] == 0) {
+            // kante liegt auf der schnittgeraden
+            interPts.emplace_back(dotA, 0, ptA[0]+dotA*r[0], ptA[1]+dotA*r[1], ptA[2]+dotA*r[2]);
+            interPts.emplace_back(dotB, 1, ptA[0]+dotB*r[0], ptA[1]+dotB*r[1], ptA[2]+dotB*r[2]);
+
+        } else if (sides[0] == 0) {
+            interPts.emplace_back(dotA, 0, ptA[0]+dotA*r[0], ptA[1]+dotA*r[1], ptA[2]+dotA*r[2]);
+
+        } else if (sides[1] == 0) {
+            interPts.emplace_back(dotB, 1, ptA[0]+dotB*r[0], ptA[1]+dotB*r[1], ptA[2]+dotB*r[2]);
+
+        } else {
+            double v[3];
+            vtkMath::Cross(r, e, v);
+
+            double n = vtkMath::Norm(v);
+
+            if (n > 0) {
+                double t = vtkMath::Determinant3x3(p, e, v)/(n*n);
+                interPts.emplace_back(t, NO_USE, ptA[0]+t*r[0], ptA[1]+t*r[1], ptA[2]+t*r[2]);
+            }
+        }
+
+        return;
+    }
+
     double w = std::abs(vtkMath::Determinant3x3(r, e, p));
 
     if (w < 1e-4) { // ~89.995deg
@@ -333,7 +408,7 @@ void vtkPolyDataContactFilter::InterEdgeLine (InterPtsType &interPts, const doub
 
 }
 
-void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyData *pd, vtkIdType num, const vtkIdType *poly, const double *r, const double *pt, Src src, const double *n) {
+void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyData *pd, vtkIdType num, const vtkIdType *poly, const double *r, const double *pt, Src src, const double *n, const int *sides) {
 
 #ifdef DEBUG
     std::cout << "InterPolyLine()" << std::endl;
@@ -364,7 +439,13 @@ void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyDat
         // schnittpunkt
 
         InterPtsType interPtsB;
-        vtkPolyDataContactFilter::InterEdgeLine(interPtsB, ptA, ptB, r, pt);
+
+        if (sides != nullptr) {
+            const int _sides[] = {sides[i], sides[j]};
+            vtkPolyDataContactFilter::InterEdgeLine(interPtsB, ptA, ptB, r, pt, _sides);
+        } else {
+            vtkPolyDataContactFilter::InterEdgeLine(interPtsB, ptA, ptB, r, pt);
+        }
 
         for (InterPt &p : interPtsB) {
             p.src = src;
@@ -437,6 +518,15 @@ void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyDat
         vtkMath::Cross(n, r, m);
         d = vtkMath::Dot(m, pt);
 
+        // abstand zur schnittgeraden, mit sides exakt im vorzeichen
+        auto Side = [&](vtkIdType k) -> double {
+            if (sides != nullptr) {
+                return sides[k];
+            }
+            pd->GetPoint(poly[k], q);
+            return vtkMath::Dot(m, q)-d;
+        };
+
         std::map<vtkIdType, double> ends;
 
         for (const auto &p : _paired) {
@@ -461,8 +551,7 @@ void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyDat
 
                 if (p.size() == 2) {
                     if (ends.count(after) == 0 && ends.count(before) == 1) {
-                        pd->GetPoint(poly[after], q);
-                        e = vtkMath::Dot(m, q)-d;
+                        e = Side(after);
 
                         t = ends[before];
 
@@ -474,8 +563,7 @@ void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyDat
                         continue;
 
                     } else if (ends.count(before) == 0 && ends.count(after) == 1) {
-                        pd->GetPoint(poly[before], q);
-                        e = vtkMath::Dot(m, q)-d;
+                        e = Side(before);
 
                         t = ends[after];
 
@@ -493,8 +581,8 @@ void vtkPolyDataContactFilter::InterPolyLine (InterPtsType &interPts, vtkPolyDat
                     pd->GetPoint(poly[after], ptA);
                     pd->GetPoint(poly[before], ptB);
 
-                    dA = vtkMath::Dot(m, ptA)-d;
-                    dB = vtkMath::Dot(m, ptB)-d;
+                    dA = Side(after);
+                    dB = Side(before);
 
                     if (std::signbit(dA) != std::signbit(dB)) {
                         if (p.size() == 2) {
@@ -603,8 +691,38 @@ void vtkPolyDataContactFilter::InterPolys (vtkIdType idA, vtkIdType idB) {
 
         InterPtsType intersA, intersB;
 
+#ifdef EXACT_PREDICATES
+        // exakte lage der punkte zur jeweils anderen ebene
+
+        std::vector<int> sidesA, sidesB;
+
+        if (GetSides(pdB, polyB, nB, pdA, numA, polyA, sidesA)
+            && GetSides(pdA, polyA, nA, pdB, numB, polyB, sidesB)) {
+
+            auto Apart = [](const std::vector<int> &sides) {
+                return std::all_of(sides.begin(), sides.end(), [&sides](int side) { return side != 0 && side == sides.front(); });
+            };
+
+            if (Apart(sidesA) || Apart(sidesB)) {
+                return;
+            }
+
+            // vorzeichen wie in InterPolyLine: e = dot(n x r, q)-d
+            for (int &side : sidesA) {
+                side = -side;
+            }
+
+            vtkPolyDataContactFilter::InterPolyLine(intersA, pdA, numA, polyA, r, s, Src::A, nA, sidesA.data());
+            vtkPolyDataContactFilter::InterPolyLine(intersB, pdB, numB, polyB, r, s, Src::B, nB, sidesB.data());
+
+        } else {
+            vtkPolyDataContactFilter::InterPolyLine(intersA, pdA, numA, polyA, r, s, Src::A, nA);
+            vtkPolyDataContactFilter::InterPolyLine(intersB, pdB, numB, polyB, r, s, Src::B, nB);
+        }
+#else
         vtkPolyDataContactFilter::InterPolyLine(intersA, pdA, numA, polyA, r, s, Src::A, nA);
         vtkPolyDataContactFilter::InterPolyLine(intersB, pdB, numB, polyB, r, s, Src::B, nB);
+#endif
 
 #ifdef DEBUG
         std::cout << "intersA " << intersA.size()
@@ -654,6 +772,31 @@ void vtkPolyDataContactFilter::InterPolys (vtkIdType idA, vtkIdType idB) {
 
 }
 
+bool vtkPolyDataContactFilter::GetSides (vtkPolyData *pd, const vtkIdType *poly, const double *n, vtkPolyData *pdOther, vtkIdType numOther, const vtkIdType *polyOther, std::vector<int> &sides) {
+
+    // vorzeichen der abstände der punkte von polyOther zur ebene von poly (in richtung n)
+
+    // es ist dieselbe ebene wie in InterPolys, aus n und dem ersten punkt, auf ihr liegen auch r und s
+
+    if (n[0] == 0 && n[1] == 0 && n[2] == 0) {
+        // entartetes polygon
+        return false;
+    }
+
+    double p[3], pt[3];
+    pd->GetPoint(poly[0], p);
+
+    sides.resize(numOther);
+
+    for (vtkIdType i = 0; i < numOther; i++) {
+        pdOther->GetPoint(polyOther[i], pt);
+        sides[i] = Sign(OrientPlane(n, p, pt));
+    }
+
+    return true;
+
+}
+
 void vtkPolyDataContactFilter::OverlapLines (OverlapsType &ols, InterPtsType &intersA, InterPtsType &intersB) {
 
     auto Add = [](InterPt &a, InterPt &b, InterPt &c, InterPt &d) {
@@ -854,6 +997,11 @@ void vtkPolyDataContactFilter::AddMissingLines (vtkPolyData *lines) {
 int vtkPolyDataContactFilter::InterOBBNodes (vtkOBBNode *nodeA, vtkOBBNode *nodeB, vtkMatrix4x4 *vtkNotUsed(mat), void *caller) {
     vtkPolyDataContactFilter *self = reinterpret_cast<vtkPolyDataContactFilter*>(caller);
 
+    // der baum wird nach einem abbruch noch durchlaufen, aber ohne arbeit
+    if (self->GetAbortExecute()) {
+        return 0;
+    }
+
     vtkIdList *cellsA = nodeA->Cells;
     vtkIdList *cellsB = nodeB->Cells;
 
@@ -870,6 +1018,16 @@ int vtkPolyDataContactFilter::InterOBBNodes (vtkOBBNode *nodeA, vtkOBBNode *node
 
             self->InterPolys(ci, cj);
         }
+
+        if (self->visitedA[ci] == 0) {
+            self->visitedA[ci] = 1;
+            self->numVisitedA++;
+        }
+    }
+
+    // UpdateProgress ruft die observer auf, daher nur bei jedem 256. knotenpaar
+    if ((self->numCalls++ & 255) == 0) {
+        self->UpdateProgress(.3+.6*std::min(1., static_cast<double>(self->numVisitedA)/std::max<vtkIdType>(self->numCandsA, 1)));
     }
 
     return 0;
@@ -95,10 +95,12 @@ typedef std::map<Pair, std::vector<LonePt>> LonePtsType;
 
 class VTK_EXPORT vtkPolyDataContactFilter : public vtkPolyDataAlgorithm {
 
-    void PreparePolyData (vtkPolyData *pd);
+    // ohne vollständige kopie der eingabe, die ausgaben 1 und 2 teilen sich die punkte mit den eingaben
+    void PreparePolyData (vtkPolyData *in, vtkPolyData *pd);
 
-    static void InterEdgeLine (InterPtsType &interPts, const double *eA, const double *eB, const double *r, const double *pt);
-    static void InterPolyLine (InterPtsType &interPts, vtkPolyData *pd, vtkIdType num, const vtkIdType *poly, const double *r, const double *pt, Src src, const double *n);
+    static void InterEdgeLine (InterPtsType &interPts, const double *eA, const double *eB, const double *r, const double *pt, const int *sides = nullptr);
+    static void InterPolyLine (InterPtsType &interPts, vtkPolyData *pd, vtkIdType num, const vtkIdType *poly, const double *r, const double *pt, Src src, const double *n, const int *sides = nullptr);
+    static bool GetSides (vtkPolyData *pd, const vtkIdType *poly, const double *n, vtkPolyData *pdOther, vtkIdType numOther, const vtkIdType *polyOther, std::vector<int> &sides);
     void InterPolys (vtkIdType idA, vtkIdType idB);
     static void OverlapLines (OverlapsType &ols, InterPtsType &intersA, InterPtsType &intersB);
 
@@ -113,6 +115,11 @@ class VTK_EXPORT vtkPolyDataContactFilter : public vtkPolyDataAlgorithm {
 
     vtkIntArray *sourcesA, *sourcesB;
 
+    // der fortschritt wird über die besuchten zellen von pdA geschätzt
+    std::vector<char> visitedA;
+    vtkIdType numVisitedA, numCandsA;
+    unsigned int numCalls;
+
 public:
     vtkTypeMacro(vtkPolyDataContactFilter, vtkPolyDataAlgorithm);
 
@@ -0,0 +1,523 @@
+/*
+Copyright 2012-2020 Ronald Römer
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// python-modul vtkboolNumPy, arbeitet direkt auf puffern (numpy-arrays, memoryviews) statt auf vtkPolyData
+//
+// boolean(pointsA, polysA, pointsB, polysB, oper_mode=0, dec_polys=True, dec_mode=0)
+//
+// points sind float64[N, 3], polys entweder int32/int64[M, k] oder ein tupel (offsets, connectivity)
+// das ergebnis ist ein dict aus memoryviews: points, offsets, connectivity, OrigCellIdsA, OrigCellIdsB
+
+#include <Python.h>
+
+#include <vtkVersionMacros.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+#include <vtkCommand.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <stdexcept>
+
+#include "vtkPolyDataBooleanFilter.h"
+
+// hält die puffer der eingaben, solange die berechnung läuft
+
+class BufferGuard {
+    // deque, damit die zeiger auf frühere puffer gültig bleiben
+    std::deque<Py_buffer> views;
+public:
+    ~BufferGuard () {
+        for (Py_buffer &view : views) {
+            PyBuffer_Release(&view);
+        }
+    }
+
+    Py_buffer* Get (PyObject *obj) {
+        Py_buffer view;
+
+        if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+            throw std::invalid_argument("object does not support the buffer protocol or is not contiguous");
+        }
+
+        views.push_back(view);
+
+        return &views.back();
+    }
+};
+
+// numpy kennzeichnet die byte-reihenfolge mit <, = oder @
+
+char GetType (const Py_buffer *view) {
+    const char *f = view->format == nullptr ? "B" : view->format;
+
+    if (*f == '<' || *f == '=' || *f == '@') {
+        f++;
+    }
+
+    return *f;
+}
+
+bool IsInt (const Py_buffer *view, Py_ssize_t size) {
+    char t = GetType(view);
+    return view->itemsize == size && (t == 'i' || t == 'l' || t == 'q');
+}
+
+// das array verweist nur auf den puffer, vtk gibt ihn nicht frei
+
+template<typename T, typename A>
+vtkSmartPointer<A> Wrap (Py_buffer *view, int comps = 1) {
+    vtkSmartPointer<A> arr = vtkSmartPointer<A>::New();
+    arr->SetNumberOfComponents(comps);
+    arr->SetArray(static_cast<T*>(view->buf), view->len/sizeof(T), 1);
+
+    return arr;
+}
+
+void SetPolys (vtkPolyData *pd, BufferGuard &guard, PyObject *polys) {
+    vtkIdType numPts = pd->GetNumberOfPoints();
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+
+    Py_buffer *offs = nullptr, *conn = nullptr;
+
+    vtkIdType numCells, k = 0;
+
+    if (PyTuple_Check(polys) && PyTuple_Size(polys) == 2) {
+        offs = guard.Get(PyTuple_GetItem(polys, 0));
+        conn = guard.Get(PyTuple_GetItem(polys, 1));
+
+        if (!IsInt(offs, conn->itemsize)) {
+            throw std::invalid_argument("offsets and connectivity must have the same type");
+        }
+
+        numCells = offs->len/offs->itemsize-1;
+
+    } else {
+        conn = guard.Get(polys);
+
+        if (conn->ndim != 2) {
+            throw std::invalid_argument("polys must have the shape (M, k)");
+        }
+
+        numCells = conn->shape[0];
+        k = conn->shape[1];
+    }
+
+    if (!IsInt(conn, 4) && !IsInt(conn, 8)) {
+        throw std::invalid_argument("polys must be int32 or int64");
+    }
+
+    if (numCells < 0) {
+        throw std::invalid_argument("offsets must not be empty");
+    }
+
+    // ungültige indizes würden vtk zum absturz bringen
+
+    auto Get = [](const Py_buffer *view, vtkIdType i) -> vtkIdType {
+        return view->itemsize == 8
+            ? static_cast<const vtkTypeInt64*>(view->buf)[i]
+            : static_cast<const vtkTypeInt32*>(view->buf)[i];
+    };
+
+    vtkIdType numIds = conn->len/conn->itemsize;
+
+    if (offs != nullptr) {
+        if (Get(offs, 0) != 0 || Get(offs, numCells) != numIds) {
+            throw std::invalid_argument("offsets must start with 0 and end with the length of connectivity");
+        }
+
+        for (vtkIdType i = 0; i < numCells; i++) {
+            if (Get(offs, i) > Get(offs, i+1)) {
+                throw std::invalid_argument("offsets must not decrease");
+            }
+        }
+    }
+
+    for (vtkIdType i = 0; i < numIds; i++) {
+        vtkIdType id = Get(conn, i);
+
+        if (id < 0 || id >= numPts) {
+            throw std::invalid_argument("index out of range in polys");
+        }
+    }
+
+    // bei festem k müssen die offsets erzeugt werden, die indizes selbst werden nicht kopiert
+
+#if VTK_MAJOR_VERSION >= 9
+    if (conn->itemsize == 8) {
+        vtkSmartPointer<vtkTypeInt64Array> _offs;
+
+        if (offs != nullptr) {
+            _offs = Wrap<vtkTypeInt64, vtkTypeInt64Array>(offs);
+        } else {
+            _offs = vtkSmartPointer<vtkTypeInt64Array>::New();
+            _offs->SetNumberOfValues(numCells+1);
+
+            for (vtkIdType i = 0; i <= numCells; i++) {
+                _offs->SetValue(i, i*k);
+            }
+        }
+
+        auto _conn = Wrap<vtkTypeInt64, vtkTypeInt64Array>(conn);
+
+        cells->SetData(_offs.Get(), _conn.Get());
+
+    } else {
+        vtkSmartPointer<vtkTypeInt32Array> _offs;
+
+        if (offs != nullptr) {
+            _offs = Wrap<vtkTypeInt32, vtkTypeInt32Array>(offs);
+        } else {
+            _offs = vtkSmartPointer<vtkTypeInt32Array>::New();
+            _offs->SetNumberOfValues(numCells+1);
+
+            for (vtkIdType i = 0; i <= numCells; i++) {
+                _offs->SetValue(i, static_cast<vtkTypeInt32>(i*k));
+            }
+        }
+
+        auto _conn = Wrap<vtkTypeInt32, vtkTypeInt32Array>(conn);
+
+        cells->SetData(_offs.Get(), _conn.Get());
+    }
+#else
+    // vor vtk 9 stehen die anzahlen zwischen den indizes, die zellen müssen umkopiert werden
+
+    auto Off = [offs, k, &Get](vtkIdType i) -> vtkIdType {
+        return offs == nullptr ? i*k : Get(offs, i);
+    };
+
+    vtkSmartPointer<vtkIdTypeArray> legacy = vtkSmartPointer<vtkIdTypeArray>::New();
+    legacy->SetNumberOfValues(numCells+Off(numCells));
+
+    vtkIdType *ptr = legacy->GetPointer(0);
+
+    for (vtkIdType i = 0; i < numCells; i++) {
+        vtkIdType a = Off(i), b = Off(i+1);
+
+        *ptr++ = b-a;
+
+        for (vtkIdType j = a; j < b; j++) {
+            *ptr++ = Get(conn, j);
+        }
+    }
+
+    cells->SetCells(numCells, legacy);
+#endif
+
+    pd->SetPolys(cells);
+}
+
+vtkSmartPointer<vtkPolyData> MakePolyData (BufferGuard &guard, PyObject *points, PyObject *polys) {
+    Py_buffer *pts = guard.Get(points);
+
+    if (GetType(pts) != 'd' || pts->itemsize != 8 || pts->len%24 != 0) {
+        throw std::invalid_argument("points must be float64 with the shape (N, 3)");
+    }
+
+    vtkSmartPointer<vtkPoints> _pts = vtkSmartPointer<vtkPoints>::New();
+    _pts->SetData(Wrap<double, vtkDoubleArray>(pts, 3));
+
+    vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+    pd->SetPoints(_pts);
+
+    SetPolys(pd, guard, polys);
+
+    return pd;
+}
+
+// exportiert den speicher eines vtkDataArray, das array lebt so lange wie der puffer
+
+struct ArrayBuffer {
+    PyObject_HEAD
+    vtkDataArray *arr;
+    Py_ssize_t shape[2], strides[2];
+    int ndim;
+    char format[2];
+};
+
+static int ArrayBuffer_GetBuffer (PyObject *self, Py_buffer *view, int flags) {
+    ArrayBuffer *b = reinterpret_cast<ArrayBuffer*>(self);
+
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "buffer is read-only");
+        view->obj = nullptr;
+        return -1;
+    }
+
+    view->obj = self;
+    Py_INCREF(self);
+
+    view->buf = b->arr->GetVoidPointer(0);
+    view->itemsize = b->arr->GetDataTypeSize();
+    view->len = b->shape[0]*(b->ndim == 2 ? b->shape[1] : 1)*view->itemsize;
+    view->readonly = 1;
+    view->format = (flags & PyBUF_FORMAT) ? b->format : nullptr;
+    view->ndim = b->ndim;
+    view->shape = (flags & PyBUF_ND) ? b->shape : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? b->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+
+    return 0;
+}
+
+static void ArrayBuffer_Dealloc (PyObject *self) {
+    reinterpret_cast<ArrayBuffer*>(self)->arr->UnRegister(nullptr);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyBufferProcs arrayBufferProcs;
+static PyTypeObject arrayBufferType = PyTypeObject();
+
+char GetFormat (vtkDataArray *arr) {
+    switch (arr->GetDataType()) {
+        case VTK_DOUBLE: return 'd';
+        case VTK_FLOAT: return 'f';
+        case VTK_INT: return 'i';
+        default: break;
+    }
+
+    if (arr->GetDataTypeSize() == 8) {
+        return 'q';
+    }
+
+    throw std::runtime_error("unsupported array type");
+}
+
+PyObject* Export (vtkDataArray *arr) {
+    ArrayBuffer *b = PyObject_New(ArrayBuffer, &arrayBufferType);
+
+    if (b == nullptr) {
+        return nullptr;
+    }
+
+    arr->Register(nullptr);
+
+    b->arr = arr;
+
+    int comps = arr->GetNumberOfComponents();
+
+    b->ndim = comps > 1 ? 2 : 1;
+    b->shape[0] = arr->GetNumberOfTuples();
+    b->shape[1] = comps;
+    b->strides[0] = comps*arr->GetDataTypeSize();
+    b->strides[1] = arr->GetDataTypeSize();
+    b->format[0] = GetFormat(arr);
+    b->format[1] = '\0';
+
+    PyObject *view = PyMemoryView_FromObject(reinterpret_cast<PyObject*>(b));
+    Py_DECREF(b);
+
+    return view;
+}
+
+class ErrorObserver : public vtkCommand {
+public:
+    std::string msg;
+
+    static ErrorObserver* New () {
+        return new ErrorObserver;
+    }
+
+    void Execute (vtkObject *vtkNotUsed(caller), unsigned long vtkNotUsed(event), void *calldata) override {
+        if (msg.empty()) {
+            msg = static_cast<char*>(calldata);
+        }
+    }
+};
+
+static PyObject* Boolean (PyObject *vtkNotUsed(self), PyObject *args, PyObject *kwargs) {
+    static const char *kws[] = {"pointsA", "polysA", "pointsB", "polysB", "oper_mode", "dec_polys", "dec_mode", nullptr};
+
+    PyObject *pointsA, *polysA, *pointsB, *polysB;
+    int operMode = OPER_UNION, decPolys = 1, decMode = DEC_MINIMAL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOO|iii", const_cast<char**>(kws),
+        &pointsA, &polysA, &pointsB, &polysB, &operMode, &decPolys, &decMode)) {
+
+        return nullptr;
+    }
+
+    BufferGuard guard;
+
+    vtkSmartPointer<vtkPolyData> pdA, pdB;
+
+    try {
+        pdA = MakePolyData(guard, pointsA, polysA);
+        pdB = MakePolyData(guard, pointsB, polysB);
+    } catch (const std::exception &e) {
+        // PyObject_GetBuffer hat den fehler eventuell schon gesetzt
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, e.what());
+        }
+        return nullptr;
+    }
+
+    vtkSmartPointer<vtkPolyDataBooleanFilter> bf = vtkSmartPointer<vtkPolyDataBooleanFilter>::New();
+    bf->SetInputData(0, pdA);
+    bf->SetInputData(1, pdB);
+    bf->SetOperMode(operMode);
+    bf->SetDecPolys(decPolys != 0);
+    bf->SetDecMode(decMode);
+
+    vtkSmartPointer<ErrorObserver> obs = vtkSmartPointer<ErrorObserver>::New();
+    bf->AddObserver(vtkCommand::ErrorEvent, obs);
+
+    // die berechnung berührt keine python-objekte
+    Py_BEGIN_ALLOW_THREADS
+    bf->Update();
+    Py_END_ALLOW_THREADS
+
+    if (!obs->msg.empty()) {
+        PyErr_SetString(PyExc_RuntimeError, obs->msg.c_str());
+        return nullptr;
+    }
+
+    vtkPolyData *res = bf->GetOutput(0);
+
+    vtkSmartPointer<vtkDataArray> offs, conn;
+
+    vtkCellArray *polys = res->GetPolys();
+
+#if VTK_MAJOR_VERSION >= 9
+    offs = polys->GetOffsetsArray();
+    conn = polys->GetConnectivityArray();
+#else
+    vtkIdType numCells = polys->GetNumberOfCells();
+
+    vtkSmartPointer<vtkIdTypeArray> _offs = vtkSmartPointer<vtkIdTypeArray>::New();
+    _offs->SetNumberOfValues(numCells+1);
+
+    vtkSmartPointer<vtkIdTypeArray> _conn = vtkSmartPointer<vtkIdTypeArray>::New();
+    _conn->SetNumberOfValues(polys->GetNumberOfConnectivityEntries()-numCells);
+
+    vtkIdType n, *ids, i = 0, j = 0;
+
+    _offs->SetValue(0, 0);
+
+    for (polys->InitTraversal(); polys->GetNextCell(n, ids);) {
+        for (vtkIdType k = 0; k < n; k++) {
+            _conn->SetValue(j++, ids[k]);
+        }
+
+        _offs->SetValue(++i, j);
+    }
+
+    offs = _offs;
+    conn = _conn;
+#endif
+
+    PyObject *dict = PyDict_New();
+
+    if (dict == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<std::pair<const char*, vtkDataArray*>> arrs {
+        {"points", res->GetPoints() != nullptr ? res->GetPoints()->GetData() : nullptr},
+        {"offsets", offs},
+        {"connectivity", conn},
+        {"OrigCellIdsA", res->GetCellData()->GetArray("OrigCellIdsA")},
+        {"OrigCellIdsB", res->GetCellData()->GetArray("OrigCellIdsB")}
+    };
+
+    try {
+        for (auto &arr : arrs) {
+            if (arr.second == nullptr) {
+                continue;
+            }
+
+            PyObject *view = Export(arr.second);
+
+            if (view == nullptr || PyDict_SetItemString(dict, arr.first, view) != 0) {
+                Py_XDECREF(view);
+                Py_DECREF(dict);
+                return nullptr;
+            }
+
+            Py_DECREF(view);
+        }
+    } catch (const std::exception &e) {
+        Py_DECREF(dict);
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return nullptr;
+    }
+
+    return dict;
+}
+
+static PyMethodDef methods[] = {
+    {"boolean", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)()>(Boolean)), METH_VARARGS | METH_KEYWORDS,
+        "boolean(pointsA, polysA, pointsB, polysB, oper_mode=0, dec_polys=True, dec_mode=0) -> dict of memoryviews"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static bool InitTypes () {
+    arrayBufferProcs.bf_getbuffer = ArrayBuffer_GetBuffer;
+    arrayBufferProcs.bf_releasebuffer = nullptr;
+
+    // entspricht PyVarObject_HEAD_INIT, den typ setzt PyType_Ready
+#if PY_VERSION_HEX >= 0x030900A4
+    Py_SET_REFCNT(&arrayBufferType, 1);
+#else
+    Py_REFCNT(&arrayBufferType) = 1;
+#endif
+
+    arrayBufferType.tp_name = "vtkboolNumPy.ArrayBuffer";
+    arrayBufferType.tp_basicsize = sizeof(ArrayBuffer);
+    arrayBufferType.tp_dealloc = ArrayBuffer_Dealloc;
+    arrayBufferType.tp_as_buffer = &arrayBufferProcs;
+    arrayBufferType.tp_flags = Py_TPFLAGS_DEFAULT;
+
+#if PY_MAJOR_VERSION < 3
+    arrayBufferType.tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+
+    return PyType_Ready(&arrayBufferType) == 0;
+}
+
+#if PY_MAJOR_VERSION >= 3
+
+static PyModuleDef module = {PyModuleDef_HEAD_INIT, "vtkboolNumPy", nullptr, -1, methods, nullptr, nullptr, nullptr, nullptr};
+
+PyMODINIT_FUNC PyInit_vtkboolNumPy () {
+    if (!InitTypes()) {
+        return nullptr;
+    }
+
+    return PyModule_Create(&module);
+}
+
+#else
+
+PyMODINIT_FUNC initvtkboolNumPy () {
+    if (InitTypes()) {
+        Py_InitModule("vtkboolNumPy", methods);
+    }
+}
+
+#endif